@@ -1,11 +1,15 @@
 #include "Atlas.h"
+#include "Trace.h"
 #include <algorithm>
+#include <cstring>
 
-void Atlas::StartLayout(int w, int h, int padding)
+void Atlas::StartLayout(int w, int h, int padding, PixelFormat format, u32 clearPixel)
 {
 	m_width = w;
 	m_height = h;
 	m_padding = padding;
+	m_format = format;
+	m_clearPixel = clearPixel;
 	for (auto& page : m_pages)
 	{
 		if (page.m_texture)
@@ -19,13 +23,23 @@ void Atlas::StartLayout(int w, int h, int padding)
 
 void Atlas::AddBlock(FontChar *item)
 {
-	m_access.lock();
+	// every glyph task comes through here, so time spent waiting for the lock is traced
+	{
+		TraceScope trace("atlas lock");
+		m_access.lock();
+	}
 	m_blocks.push_back(item);
 	m_access.unlock();
 }
 
-void Atlas::LayoutBlocks()
+void Atlas::LayoutBlocks(bool release)
 {
+	// glyphs of the next batch can still be adding blocks
+	std::vector<FontChar*> blocks;
+	m_access.lock();
+	blocks.swap(m_blocks);
+	m_access.unlock();
+
 	auto presort_compare = [](const FontChar* a, const FontChar* b) -> bool
 		{
 			return a->ch < b->ch;
@@ -35,10 +49,10 @@ void Atlas::LayoutBlocks()
 		{
 			return a->pb_scaledSDF.crop_h < b->pb_scaledSDF.crop_h;
 		};
-	std::sort(m_blocks.begin(), m_blocks.end(), presort_compare);
-	std::sort(m_blocks.begin(), m_blocks.end(), compare);
+	std::sort(blocks.begin(), blocks.end(), presort_compare);
+	std::sort(blocks.begin(), blocks.end(), compare);
 
-	for (auto item : m_blocks)
+	for (auto item : blocks)
 	{
 		if (!TryAddBlock(item))
 		{
@@ -48,22 +62,81 @@ void Atlas::LayoutBlocks()
 				SDL_assert(false);
 			}
 		}
+		if (release)
+			item->pb_scaledSDF.Free();
 	}
 }
 
 void Atlas::CreatePageTextures()
 {
+	m_access.lock();
 	for (auto& page : m_pages)
 	{
 		page.m_texture = SDL_CreateTextureFromSurface(m_renderer, page.m_surface);
+		page.m_dirty = false;
 	}
 	m_blocks.clear();
+	m_access.unlock();
+}
+
+void Atlas::UpdateBlock(const FontChar* item, const PixelBlock& block)
+{
+	if (item->w == 0 || item->h == 0 || block.format != m_format)
+		return;
+	if (item->blockX + item->w > block.w || item->blockY + item->h > block.h)
+		return;
+
+	{
+		TraceScope trace("atlas lock");
+		m_access.lock();
+	}
+	if (item->page < (int)m_pages.size())
+	{
+		Page& page = m_pages[item->page];
+		int bpp = block.BytesPerPixel();
+		u8* dest_pixels = (u8*)page.m_surface->pixels + item->y * page.m_surface->pitch + item->x * bpp;
+		for (int yy = 0; yy < item->h; yy++)
+		{
+			memcpy(dest_pixels, block.Row(item->blockY + yy) + item->blockX * bpp, item->w * bpp);
+			dest_pixels += page.m_surface->pitch;
+		}
+		page.m_dirty = true;
+	}
+	m_access.unlock();
+}
+
+void Atlas::RefreshPageTextures()
+{
+	m_access.lock();
+	for (auto& page : m_pages)
+	{
+		if (page.m_dirty && page.m_texture)
+		{
+			SDL_DestroyTexture(page.m_texture);
+			page.m_texture = SDL_CreateTextureFromSurface(m_renderer, page.m_surface);
+			page.m_dirty = false;
+		}
+	}
+	m_access.unlock();
 }
 
 void Atlas::AddNewPage()
 {
 	Page page;
-	page.m_surface = SDL_CreateSurface(m_width, m_height, SDL_PIXELFORMAT_ARGB8888);
+	if (m_format == PixelFormat::A8)
+	{
+		// A8 pages are 8 bit indexed with a white palette ramping up the alpha
+		page.m_surface = SDL_CreateSurface(m_width, m_height, SDL_PIXELFORMAT_INDEX8);
+		SDL_Palette* palette = SDL_CreateSurfacePalette(page.m_surface);
+		SDL_Color colors[256];
+		for (int i = 0; i < 256; i++)
+			colors[i] = { 255, 255, 255, (u8)i };
+		SDL_SetPaletteColors(palette, colors, 0, 256);
+	}
+	else
+	{
+		page.m_surface = SDL_CreateSurface(m_width, m_height, SDL_PIXELFORMAT_ARGB8888);
+	}
 	SDL_LockSurface(page.m_surface);
 	m_pages.push_back(page);
 
@@ -72,11 +145,19 @@ void Atlas::AddNewPage()
 		m_columnHeights[c] = 0;
 
 	// clear the page
-	int size = m_width * m_height;
-	u32* pixels = (u32*)page.m_surface->pixels;
-	while (size--)
+	for (int y = 0; y < m_height; y++)
 	{
-		*pixels++ = 0x00ffffff;
+		u8* row = (u8*)page.m_surface->pixels + y * page.m_surface->pitch;
+		if (m_format == PixelFormat::A8)
+		{
+			memset(row, 0, m_width);
+		}
+		else
+		{
+			u32* pixels = (u32*)row;
+			for (int x = 0; x < m_width; x++)
+				*pixels++ = m_clearPixel;
+		}
 	}
 
 	m_addPageX = 0;
@@ -122,27 +203,22 @@ bool Atlas::TryAddBlock(FontChar *item)
 	}
 
 	// ok, copy that block in
-	auto dest_surface = m_pages.back().m_surface;
-	int dest_pitch = dest_surface->pitch / 4;
-	u32* dest_pixels = (u32*)dest_surface->pixels;
-	dest_pixels += highest * dest_pitch;
+	const PixelBlock& block = item->pb_scaledSDF;
+	SDL_assert(block.format == m_format);
+	int bpp = block.BytesPerPixel();
 
-	int src_pitch = item->pb_scaledSDF.pitch/4;
-	u32* src_pixels = &item->pb_scaledSDF.pixels[item->pb_scaledSDF.crop_y * src_pitch];
+	auto dest_surface = m_pages.back().m_surface;
+	u8* dest_pixels = (u8*)dest_surface->pixels + highest * dest_surface->pitch;
 
 	item->x = m_addPageX;
 	item->y = highest;
+	item->blockX = block.crop_x;
+	item->blockY = block.crop_y;
 		
 	for (int yy = 0; yy < item->h; yy++)
 	{
-		u32* dest = &dest_pixels[m_addPageX];
-		u32* src = &src_pixels[item->pb_scaledSDF.crop_x];
-		for (int xx = 0; xx < item->w; xx++)
-		{
-			*dest++ = *src++;
-		}
-		dest_pixels += dest_pitch;
-		src_pixels += src_pitch;
+		memcpy(dest_pixels + m_addPageX * bpp, block.Row(block.crop_y + yy) + block.crop_x * bpp, item->w * bpp);
+		dest_pixels += dest_surface->pitch;
 	}
 
 	m_addPageX += item->w + m_padding;
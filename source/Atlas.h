@@ -31,14 +31,23 @@ public:
 	{
 		SDL_Surface* m_surface = nullptr;
 		SDL_Texture* m_texture = nullptr;
+		bool m_dirty = false;		// changed by UpdateBlock since the texture was made
 	};
 
 	void SetRenderer(SDL_Renderer* renderer) { m_renderer = renderer; }
-	void StartLayout(int w, int h, int padding);
+	// clearPixel fills new ARGB pages - white transparent for coverage, 0 for MSDF so the gaps read as outside
+	void StartLayout(int w, int h, int padding, PixelFormat format = PixelFormat::A8, u32 clearPixel = 0x00ffffff);
 	void AddBlock(FontChar *item);
-	void LayoutBlocks();
+	// places every block added since the last layout on the pages after the ones already placed
+	// release frees each block's pixels once they're copied, so a streaming bake can lay out batch by batch
+	void LayoutBlocks(bool release = false);
 	void CreatePageTextures();
+	// copies the same rect of a new block for an already placed glyph over the old pixels - the block has to have the old one's layout
+	void UpdateBlock(const FontChar* item, const PixelBlock& block);
+	// remakes the textures of pages UpdateBlock changed, on the render thread
+	void RefreshPageTextures();
 	std::vector<Page>& Pages() { return m_pages; }
+	PixelFormat Format() const { return m_format; }
 
 private:
 	bool TryAddBlock(FontChar *item);
@@ -51,6 +60,8 @@ private:
 	int m_width = 0;
 	int m_height = 0;
 	int m_padding = 1;
+	PixelFormat m_format = PixelFormat::A8;
+	u32 m_clearPixel = 0x00ffffff;
 	
 	std::vector<Page> m_pages;
 	int m_addPageX = 0;
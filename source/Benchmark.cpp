@@ -0,0 +1,607 @@
+#include "Benchmark.h"
+#include "PixelBlock.h"
+#include "FontPool.h"
+#include "GlyphRaster.h"
+#include "WorkerFarm.h"
+#include "SDL3/SDL.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <format>
+#include <functional>
+#include <thread>
+#include <vector>
+
+// signed distance to a ring with a stem through it, positive inside - enough curved and straight edges to look like a real glyph
+// exact outside the glyph, inside where the ring and stem overlap it's only a lower bound
+static float TestGlyphDistance(int size, int variant, float x, float y)
+{
+    float cx = size * (0.45f + variant * 0.05f);
+    float cy = size * 0.5f;
+    float outer = size * (0.3f - variant * 0.03f);
+    float inner = outer * 0.65f;
+    float d = sqrtf((x - cx) * (x - cx) + (y - cy) * (y - cy));
+    float ring = std::min(outer - d, d - inner);
+
+    float dx = std::max(size * 0.6f - x, x - size * 0.68f);
+    float dy = std::max(size * 0.1f - y, y - size * 0.9f);
+    float stem = dx <= 0.0f && dy <= 0.0f ? -std::max(dx, dy) : -sqrtf(std::max(dx, 0.0f) * std::max(dx, 0.0f) + std::max(dy, 0.0f) * std::max(dy, 0.0f));
+    return std::max(ring, stem);
+}
+
+// samples > 1 gives anti-aliased coverage from samples x samples points per pixel, 1 a hard edged raster
+static void MakeTestGlyph(PixelBlock& pb, int size, int variant, int samples = 1)
+{
+    pb.Allocate(size, size, PixelFormat::A8);
+
+    for (int y = 0; y < size; y++)
+    {
+        for (int x = 0; x < size; x++)
+        {
+            int covered = 0;
+            for (int sy = 0; sy < samples; sy++)
+            {
+                for (int sx = 0; sx < samples; sx++)
+                {
+                    float px = x - 0.5f + (sx + 0.5f) / samples;
+                    float py = y - 0.5f + (sy + 0.5f) / samples;
+                    if (TestGlyphDistance(size, variant, samples > 1 ? px : (float)x, samples > 1 ? py : (float)y) > 0.0f)
+                        covered++;
+                }
+            }
+            pb.Row(y)[x] = (u8)((covered * 255 + samples * samples / 2) / (samples * samples));
+        }
+    }
+    pb.CalcCropRect();
+}
+
+// mean difference in SDF levels from the analytic distance, over the outside pixels within range where the reference is exact
+static double SDFError(const PixelBlock& sdf, int range)
+{
+    double sum = 0.0;
+    int count = 0;
+    for (int y = 0; y < sdf.h; y++)
+    {
+        for (int x = 0; x < sdf.w; x++)
+        {
+            float dist = TestGlyphDistance(sdf.w, 0, (float)x, (float)y);
+            if (dist > 0.0f || dist < -range)
+                continue;
+            sum += fabsf(sdf.Row(y)[x] - (dist / range * 127.0f + 128.0f));
+            count++;
+        }
+    }
+    return count ? sum / count : 0.0;
+}
+
+static double TimeSDF(PixelBlock& dest, const PixelBlock& source, const PixelBlockDistanceFinder& df, int range, SDFEngine engine, int iterations,
+    const SDFKernelOptions& options = {})
+{
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < iterations; i++)
+        dest.GenerateSDF(source, df, range, engine, SDFOutput::Alpha8, options);
+    auto end = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count() / iterations;
+}
+
+void BenchmarkSDFKernels()
+{
+    const int size = 512;
+    const int iterations = 4;
+    const int ranges[] = { 4, 8, 16, 32 };
+    const SDFEngine engines[] = { SDFEngine::RowScan, SDFEngine::EDT };
+    const char* engineNames[] = { "RowScan", "EDT" };
+
+    PixelBlock source;
+    MakeTestGlyph(source, size, 0);
+    PixelBlockDistanceFinder df;
+    df.Generate(source);
+
+    PixelBlock generic, specialised;
+    generic.Allocate(size, size, PixelFormat::A8);
+    specialised.Allocate(size, size, PixelFormat::A8);
+
+    SDL_Log("SDF kernel benchmark - %dx%d glyph, %d iterations", size, size, iterations);
+    for (int e = 0; e < 2; e++)
+    {
+        for (int range : ranges)
+        {
+            SDFKernelOptions genericOptions;
+            genericOptions.specialised = false;
+            double genericMS = TimeSDF(generic, source, df, range, engines[e], iterations, genericOptions);
+            double specialisedMS = TimeSDF(specialised, source, df, range, engines[e], iterations);
+
+            bool identical = memcmp(generic.pixels, specialised.pixels, size * size) == 0;
+            SDL_Log("  %-8s range %2d : generic %7.2fms  specialised %7.2fms  speedup %.2fx %s", engineNames[e], range,
+                genericMS, specialisedMS, genericMS / specialisedMS, identical ? "" : "MISMATCH");
+        }
+    }
+
+    // downscale of the finished SDF to a typical atlas glyph size - the first call per size builds the shared taps
+    const ResampleFilter filters[] = { ResampleFilter::Box, ResampleFilter::Mitchell, ResampleFilter::Lanczos3 };
+    const char* filterNames[] = { "Box", "Mitchell", "Lanczos3" };
+    const int scaleIterations = 64;
+    PixelBlock scaled;
+    scaled.Allocate(32, 32, PixelFormat::A8);
+    for (int f = 0; f < 3; f++)
+    {
+        auto start = std::chrono::high_resolution_clock::now();
+        for (int i = 0; i < scaleIterations; i++)
+            scaled.Scale(specialised, filters[f]);
+        auto end = std::chrono::high_resolution_clock::now();
+        SDL_Log("  scale %-8s %d -> 32 : %6.3fms", filterNames[f], size, std::chrono::duration<double, std::milli>(end - start).count() / scaleIterations);
+    }
+
+    // full rez SDF then scale, against the fused kernel searching every pixel and 4x4 samples per output pixel
+    for (int range : ranges)
+    {
+        auto start = std::chrono::high_resolution_clock::now();
+        for (int i = 0; i < iterations; i++)
+        {
+            specialised.GenerateSDF(source, df, range, SDFEngine::RowScan);
+            scaled.Scale(specialised);
+        }
+        auto mid = std::chrono::high_resolution_clock::now();
+        for (int i = 0; i < iterations; i++)
+            scaled.GenerateScaledSDF(source, df, range);
+        auto mid2 = std::chrono::high_resolution_clock::now();
+        for (int i = 0; i < iterations; i++)
+            scaled.GenerateScaledSDF(source, df, range, ResampleFilter::Box, 4);
+        auto end = std::chrono::high_resolution_clock::now();
+        SDL_Log("  range %2d -> 32 : SDF+scale %7.2fms  fused %7.2fms  fused 4x4 %7.2fms", range,
+            std::chrono::duration<double, std::milli>(mid - start).count() / iterations,
+            std::chrono::duration<double, std::milli>(mid2 - mid).count() / iterations,
+            std::chrono::duration<double, std::milli>(end - mid2).count() / iterations);
+    }
+
+    // one huge glyph in a single call, then split into bands across the farm
+    {
+        const int hugeSize = 2048;
+        PixelBlock huge, hugeSDF;
+        MakeTestGlyph(huge, hugeSize, 0);
+        PixelBlockDistanceFinder hugeDF;
+        hugeDF.Generate(huge);
+        hugeSDF.Allocate(hugeSize, hugeSize, PixelFormat::A8);
+
+        SDFKernelOptions serialOptions;
+        serialOptions.parallel = false;
+        for (int e = 0; e < 2; e++)
+        {
+            double serialMS = TimeSDF(hugeSDF, huge, hugeDF, 32, engines[e], 1, serialOptions);
+            double bandsMS = TimeSDF(hugeSDF, huge, hugeDF, 32, engines[e], 1);
+            SDL_Log("  %-8s %dx%d range 32 : one call %7.2fms  bands %7.2fms  speedup %.2fx", engineNames[e], hugeSize, hugeSize,
+                serialMS, bandsMS, serialMS / bandsMS);
+        }
+        huge.Free();
+        hugeSDF.Free();
+    }
+
+    // hard edged raster at full size against the coverage engine on anti-aliased rasters 2x and 4x smaller each way
+    SDL_Log("  coverage - error in SDF levels against the analytic distance");
+    for (int shrink : { 1, 2, 4 })
+    {
+        int shrunk = size / shrink;
+        int range = 32 / shrink;
+        PixelBlock hard, smooth, sdf;
+        MakeTestGlyph(hard, shrunk, 0);
+        MakeTestGlyph(smooth, shrunk, 0, 16);
+        PixelBlockDistanceFinder hardDF, smoothDF;
+        hardDF.Generate(hard);
+        smoothDF.Generate(smooth);
+        sdf.Allocate(shrunk, shrunk, PixelFormat::A8);
+
+        double hardMS = TimeSDF(sdf, hard, hardDF, range, SDFEngine::EDT, iterations);
+        double hardError = SDFError(sdf, range);
+        double smoothMS = TimeSDF(sdf, smooth, smoothDF, range, SDFEngine::Coverage, iterations);
+        double smoothError = SDFError(sdf, range);
+        SDL_Log("  %3dx%-3d range %2d : EDT %7.2fms error %5.2f  Coverage %7.2fms error %5.2f", shrunk, shrunk, range,
+            hardMS, hardError, smoothMS, smoothError);
+
+        hard.Free();
+        smooth.Free();
+        sdf.Free();
+    }
+
+    source.Free();
+    generic.Free();
+    specialised.Free();
+    scaled.Free();
+}
+
+// runs render(thread, glyphIndex) on threadCount threads at once, returns glyphs/sec
+static double TimeGlyphThreads(int threadCount, int glyphsPerThread, const std::function<bool(int, int)>& render)
+{
+    std::atomic<int> rendered{ 0 };
+    auto start = std::chrono::high_resolution_clock::now();
+    std::vector<std::thread*> threads;
+    for (int t = 0; t < threadCount; t++)
+    {
+        threads.push_back(new std::thread([&render, &rendered, glyphsPerThread, t]()
+            {
+                for (int i = 0; i < glyphsPerThread; i++)
+                {
+                    if (render(t, i))
+                        rendered++;
+                }
+            }));
+    }
+    for (auto thread : threads)
+    {
+        thread->join();
+        delete thread;
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    return rendered / std::chrono::duration<double>(end - start).count();
+}
+
+void BenchmarkGlyphRaster(const std::string& ttfPath)
+{
+    // the printable latin range, rendered the same way Project::CharSDFTask does
+    std::vector<u32> glyphs;
+    for (u32 ch = 0x21; ch < 0x7f; ch++)
+        glyphs.push_back(ch);
+    const int glyphsPerThread = (int)glyphs.size() * 2;
+    const int maxThreads = std::max(1, (int)std::thread::hardware_concurrency());
+
+    SDL_Log("Glyph raster benchmark - %s at 512 points, %d glyphs per thread", ttfPath.c_str(), glyphsPerThread);
+    double singleTTF = 0.0;
+    double singleSTB = 0.0;
+    for (int threadCount = 1; threadCount <= maxThreads; threadCount++)
+    {
+        // new fonts per run so opening them is part of the cost, as it is for a real bake
+        FontPool pool(ttfPath, 512.0f, false);
+        GlyphRaster raster(ttfPath);
+        if (!pool.IsValid() || !raster.IsValid())
+            return;
+
+        // SDL_ttf ARGB surface, one font per thread
+        double ttfRate = TimeGlyphThreads(threadCount, glyphsPerThread, [&](int t, int i)
+            {
+                SDL_Color white = { 255, 255, 255, 255 };
+                TTF_Font* font = pool.ThreadFont();
+                SDL_Surface* surface = font ? TTF_RenderGlyph_Blended(font, glyphs[(i + t) % glyphs.size()], white) : nullptr;
+                SDL_DestroySurface(surface);
+                return surface != nullptr;
+            });
+
+        // stb_truetype straight into an A8 block, one shared font
+        std::vector<PixelBlock> blocks(threadCount);
+        double stbRate = TimeGlyphThreads(threadCount, glyphsPerThread, [&](int t, int i)
+            {
+                int advance;
+                raster.Render(glyphs[(i + t) % glyphs.size()], 512.0f, blocks[t], advance);
+                return true;
+            });
+        for (auto& block : blocks)
+            block.Free();
+
+        if (threadCount == 1)
+        {
+            singleTTF = ttfRate;
+            singleSTB = stbRate;
+        }
+        SDL_Log("  %2d threads : SDL_ttf %8.0f glyphs/sec (%.2fx)  stb_truetype %8.0f glyphs/sec (%.2fx)", threadCount,
+            ttfRate, ttfRate / singleTTF, stbRate, stbRate / singleSTB);
+    }
+
+    // analytic SDF from the outlines at typical atlas sizes - no raster at all
+    GlyphRaster raster(ttfPath);
+    PixelBlock block;
+    for (int size : { 32, 64 })
+    {
+        auto start = std::chrono::high_resolution_clock::now();
+        for (u32 ch : glyphs)
+        {
+            int advance;
+            raster.RenderSDF(ch, (float)size, SDFDefaultRange * size / 512, block, advance);
+        }
+        auto end = std::chrono::high_resolution_clock::now();
+        SDL_Log("  analytic SDF %dpx : %8.0f glyphs/sec", size, glyphs.size() / std::chrono::duration<double>(end - start).count());
+    }
+    block.Free();
+}
+
+// worst and mean difference in levels of 'sdf' from 'reference' over the pixels the reference doesn't saturate
+static void GlyphError(const PixelBlock& sdf, const PixelBlock& reference, int& worst, double& sum, int& count)
+{
+    if (sdf.w != reference.w || sdf.h != reference.h)
+        return;
+    for (int y = 0; y < sdf.h; y++)
+    {
+        for (int x = 0; x < sdf.w; x++)
+        {
+            int ref = reference.Row(y)[x];
+            if (ref == 0 || ref == 255)
+                continue;
+            int error = abs(sdf.Row(y)[x] - ref);
+            worst = std::max(worst, error);
+            sum += error;
+            count++;
+        }
+    }
+}
+
+void BenchmarkGlyphEngines(const std::string& ttfPath, int fontSize)
+{
+    std::vector<u32> glyphs;
+    for (u32 ch = 0x21; ch < 0x7f; ch++)
+        glyphs.push_back(ch);
+
+    // the range a new project gives the SDFs it generates itself
+    const int range = SDFDefaultOutputRange;
+
+    GlyphRaster raster(ttfPath);
+    if (!raster.IsValid())
+        return;
+
+    std::vector<PixelBlock> references(glyphs.size());
+    for (size_t i = 0; i < glyphs.size(); i++)
+    {
+        int advance;
+        raster.RenderSDF(glyphs[i], (float)fontSize, range, references[i], advance);
+    }
+
+    SDL_Log("Glyph engine benchmark - %s at %d points, range %d, %d glyphs", ttfPath.c_str(), fontSize, range, (int)glyphs.size());
+
+    auto timeGlyphs = [&](const std::function<void(u32)>& render)
+        {
+            auto start = std::chrono::high_resolution_clock::now();
+            for (u32 ch : glyphs)
+                render(ch);
+            auto end = std::chrono::high_resolution_clock::now();
+            return glyphs.size() / std::chrono::duration<double>(end - start).count();
+        };
+
+    // speed only - plain coverage has no distance, SDL_ttf uses FreeType's spread and its own layout
+    PixelBlock block;
+    double rate = timeGlyphs([&](u32 ch)
+        {
+            int advance;
+            raster.Render(ch, (float)fontSize, block, advance);
+        });
+    SDL_Log("  %-16s %8.0f glyphs/sec", "plain coverage", rate);
+
+    FontPool pool(ttfPath, (float)fontSize, true);
+    if (pool.IsValid())
+    {
+        rate = timeGlyphs([&](u32 ch)
+            {
+                SDL_Color white = { 255, 255, 255, 255 };
+                TTF_Font* font = pool.ThreadFont();
+                SDL_DestroySurface(font ? TTF_RenderGlyph_Blended(font, ch, white) : nullptr);
+            });
+        SDL_Log("  %-16s %8.0f glyphs/sec", "SDL_ttf SDF", rate);
+    }
+
+    auto report = [&](const char* name, const std::function<void(u32, PixelBlock&)>& render)
+        {
+            std::vector<PixelBlock> blocks(glyphs.size());
+            size_t next = 0;
+            double glyphRate = timeGlyphs([&](u32 ch) { render(ch, blocks[next++]); });
+
+            int worst = 0;
+            double sum = 0.0;
+            int count = 0;
+            for (size_t i = 0; i < glyphs.size(); i++)
+            {
+                GlyphError(blocks[i], references[i], worst, sum, count);
+                blocks[i].Free();
+            }
+            SDL_Log("  %-16s %8.0f glyphs/sec  max error %3d  mean error %5.2f", name, glyphRate, worst, count ? sum / count : 0.0);
+        };
+
+    // the reference itself, so only the speed means anything
+    report("outline", [&](u32 ch, PixelBlock& pb)
+        {
+            int advance;
+            raster.RenderSDF(ch, (float)fontSize, range, pb, advance);
+        });
+    for (int supersample : { 2, 4, 8, 16 })
+    {
+        std::string name = std::format("supersampled x{}", supersample);
+        report(name.c_str(), [&](u32 ch, PixelBlock& pb)
+            {
+                int advance;
+                raster.RenderSupersampledSDF(ch, (float)fontSize, range, supersample, SDFEngine::RowScan, ResampleFilter::Box, pb, advance);
+            });
+    }
+    for (int supersample : { 1, 2, 4, 8 })
+    {
+        std::string name = std::format("coverage x{}", supersample);
+        report(name.c_str(), [&](u32 ch, PixelBlock& pb)
+            {
+                int advance;
+                raster.RenderSupersampledSDF(ch, (float)fontSize, range, supersample, SDFEngine::Coverage, ResampleFilter::Box, pb, advance);
+            });
+    }
+
+    block.Free();
+    for (auto& reference : references)
+        reference.Free();
+}
+
+// renders 'order' on threadCount threads pulling the next glyph from a shared index, returns the wall time and tail in ms
+static void TimeGlyphOrder(const GlyphRaster& raster, const std::vector<u32>& order, int threadCount, int fontSize, int range, int supersample,
+    double& wallMS, double& tailMS)
+{
+    using Clock = std::chrono::high_resolution_clock;
+    std::atomic<size_t> next{ 0 };
+    std::vector<Clock::time_point> finished(threadCount);
+    auto start = Clock::now();
+    std::vector<std::thread*> threads;
+    for (int t = 0; t < threadCount; t++)
+    {
+        threads.push_back(new std::thread([&, t]()
+            {
+                PixelBlock block;
+                for (size_t i = next++; i < order.size(); i = next++)
+                {
+                    int advance;
+                    raster.RenderSupersampledSDF(order[i], (float)fontSize, range, supersample, SDFEngine::RowScan, ResampleFilter::Box, block, advance);
+                }
+                block.Free();
+                finished[t] = Clock::now();
+            }));
+    }
+    for (auto thread : threads)
+    {
+        thread->join();
+        delete thread;
+    }
+    auto firstIdle = *std::min_element(finished.begin(), finished.end());
+    auto end = *std::max_element(finished.begin(), finished.end());
+    wallMS = std::chrono::duration<double, std::milli>(end - start).count();
+    tailMS = std::chrono::duration<double, std::milli>(end - firstIdle).count();
+}
+
+void BenchmarkGlyphSchedule(const std::string& ttfPath, int fontSize, int supersample)
+{
+    GlyphRaster raster(ttfPath);
+    if (!raster.IsValid())
+        return;
+
+    // every glyph in the BMP, thinned out evenly to keep a CJK font's run short
+    const size_t maxGlyphs = 2000;
+    std::vector<u32> glyphs;
+    for (u32 ch = 0x21; ch < 0x10000; ch++)
+    {
+        if (raster.HasGlyph(ch))
+            glyphs.push_back(ch);
+    }
+    if (glyphs.size() > maxGlyphs)
+    {
+        std::vector<u32> thinned;
+        for (size_t i = 0; i < maxGlyphs; i++)
+            thinned.push_back(glyphs[i * glyphs.size() / maxGlyphs]);
+        glyphs.swap(thinned);
+    }
+
+    std::vector<std::pair<float, u32>> costs;
+    for (u32 ch : glyphs)
+        costs.push_back({ raster.EstimateCost(ch, (float)fontSize), ch });
+    std::stable_sort(costs.begin(), costs.end(), [](const auto& a, const auto& b) { return a.first > b.first; });
+    std::vector<u32> largestFirst;
+    for (auto& cost : costs)
+        largestFirst.push_back(cost.second);
+
+    const int range = SDFDefaultOutputRange;
+    const int threadCount = std::max(1, (int)std::thread::hardware_concurrency());
+    SDL_Log("Glyph schedule benchmark - %s, %d glyphs at %d points x%d on %d threads", ttfPath.c_str(), (int)glyphs.size(), fontSize, supersample, threadCount);
+
+    double wallMS, tailMS;
+    TimeGlyphOrder(raster, glyphs, threadCount, fontSize, range, supersample, wallMS, tailMS);
+    SDL_Log("  code point order    : %8.1fms  tail %7.1fms", wallMS, tailMS);
+    TimeGlyphOrder(raster, largestFirst, threadCount, fontSize, range, supersample, wallMS, tailMS);
+    SDL_Log("  largest cost first  : %8.1fms  tail %7.1fms", wallMS, tailMS);
+}
+
+void BenchmarkWorkerFarm()
+{
+    const int taskCount = 200000;
+    SDL_Log("Worker farm benchmark - %d tiny tasks per run", taskCount);
+
+    double singleOutside = 0.0;
+    double singleInside = 0.0;
+    double singleRange = 0.0;
+    for (int threadCount : { 1, 2, 4, 8, 16, 32, 64 })
+    {
+        WorkerFarm farm(threadCount);
+        std::atomic<int> counter{ 0 };
+        auto tiny = [&counter]() { counter++; };
+
+        // every task queued by this thread through the shared queue, all in one job like a project's glyphs
+        auto start = std::chrono::high_resolution_clock::now();
+        JobHandle job = std::make_shared<TaskGroup>();
+        for (int i = 0; i < taskCount; i++)
+            farm.QueueHighPriorityTask(tiny, job);
+        job->Wait();
+        auto mid = std::chrono::high_resolution_clock::now();
+
+        // a task per thread queuing the rest from inside the farm onto its own deque
+        job = std::make_shared<TaskGroup>();
+        for (int t = 0; t < threadCount; t++)
+        {
+            farm.QueueHighPriorityTask([&farm, &tiny, job, perThread = taskCount / threadCount]()
+                {
+                    for (int i = 0; i < perThread; i++)
+                        farm.QueueHighPriorityTask(tiny, job);
+                }, job);
+        }
+        job->Wait();
+        auto end = std::chrono::high_resolution_clock::now();
+
+        // the whole range in one submit, the way a project queues its glyphs
+        job = farm.QueueHighPriorityFor(taskCount, [&counter](int) { counter++; });
+        job->Wait();
+        auto endRange = std::chrono::high_resolution_clock::now();
+
+        double outside = taskCount / std::chrono::duration<double>(mid - start).count();
+        double inside = taskCount / std::chrono::duration<double>(end - mid).count();
+        double range = taskCount / std::chrono::duration<double>(endRange - end).count();
+        if (threadCount == 1)
+        {
+            singleOutside = outside;
+            singleInside = inside;
+            singleRange = range;
+        }
+        SDL_Log("  %2d threads : queued outside %10.0f tasks/sec (%.2fx)  queued inside %10.0f tasks/sec (%.2fx)  one range %10.0f tasks/sec (%.2fx)",
+            threadCount, outside, outside / singleOutside, inside, inside / singleInside, range, range / singleRange);
+    }
+}
+
+// two jobs on the same farm, one short and one long - the short one's wait should return without the other
+void BenchmarkJobWait()
+{
+    WorkerFarm farm;
+    auto sleepTask = [](int ms) { return [ms]() { std::this_thread::sleep_for(std::chrono::milliseconds(ms)); }; };
+
+    auto start = std::chrono::high_resolution_clock::now();
+    JobHandle longJob;
+    JobHandle shortJob;
+    for (int i = 0; i < farm.ThreadCount(); i++)
+    {
+        longJob = farm.QueueLowPriorityTask(sleepTask(200), longJob);
+        shortJob = farm.QueueHighPriorityTask(sleepTask(10), shortJob);
+    }
+    shortJob->Wait();
+    auto shortDone = std::chrono::high_resolution_clock::now();
+    longJob->Wait();
+    auto longDone = std::chrono::high_resolution_clock::now();
+
+    SDL_Log("Job wait benchmark - %d threads, short job of 10ms tasks with a long job of 200ms tasks", farm.ThreadCount());
+    SDL_Log("  short job waited %.1fms", std::chrono::duration<double, std::milli>(shortDone - start).count());
+    SDL_Log("  long job waited  %.1fms", std::chrono::duration<double, std::milli>(longDone - start).count());
+
+    // a job of huge SDFs cancelled part way - the wait should return within about a row of work, not the rest of the job
+    const int hugeSize = 2048;
+    PixelBlock huge;
+    MakeTestGlyph(huge, hugeSize, 0);
+    PixelBlockDistanceFinder hugeDF;
+    hugeDF.Generate(huge);
+    auto sdfTask = [&huge, &hugeDF]()
+        {
+            PixelBlock sdf;
+            sdf.Allocate(hugeSize, hugeSize, PixelFormat::A8);
+            sdf.GenerateSDF(huge, hugeDF, 32, SDFEngine::RowScan);
+            sdf.Free();
+        };
+
+    auto taskStart = std::chrono::high_resolution_clock::now();
+    sdfTask();
+    double taskMS = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - taskStart).count();
+
+    JobHandle sdfJob;
+    for (int i = 0; i < farm.ThreadCount() * 4; i++)
+        sdfJob = farm.QueueHighPriorityTask(sdfTask, sdfJob);
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    auto cancelStart = std::chrono::high_resolution_clock::now();
+    sdfJob->Cancel();
+    sdfJob->Wait();
+    double cancelMS = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - cancelStart).count();
+    huge.Free();
+
+    SDL_Log("  %d tasks of a %dx%d SDF at %.1fms each, cancelled after 20ms - waited %.2fms", farm.ThreadCount() * 4, hugeSize, hugeSize,
+        taskMS, cancelMS);
+}
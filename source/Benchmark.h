@@ -0,0 +1,23 @@
+#pragma once
+
+#include <string>
+
+// timing runs over synthetic glyph rasters - results are written with SDL_Log
+void BenchmarkSDFKernels();
+
+// glyphs/sec rasterising a font at 512 points with 1..N threads - SDL_ttf with FontPool against stb_truetype with GlyphRaster
+void BenchmarkGlyphRaster(const std::string& ttfPath);
+
+// glyphs/sec and error of every SDF source Project can use at 'fontSize' - the error is against GlyphRaster::RenderSDF's analytic distance
+void BenchmarkGlyphEngines(const std::string& ttfPath, int fontSize);
+
+// wall time and tail of a bake on every core in code point order against largest estimated cost first
+// the tail is the time from the first thread running out of glyphs to the last glyph finishing
+void BenchmarkGlyphSchedule(const std::string& ttfPath, int fontSize, int supersample);
+
+// tasks/sec through a WorkerFarm of 1..64 threads - tasks queued one at a time from outside the farm and from inside its own tasks, then as one range
+void BenchmarkWorkerFarm();
+
+// a short and a long job on one farm - each wait should return when its own tasks are done, not when the farm is idle
+// then how long a cancelled job of huge SDFs takes to stop
+void BenchmarkJobWait();
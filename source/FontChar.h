@@ -4,8 +4,6 @@
 #include "SDL3/SDL_Surface.h"
 #include "PixelBlock.h"
 
-#define SDFRange 32
-
 // source char
 struct FontChar
 {
@@ -28,6 +26,8 @@ struct FontChar
     int w = 0;      // width on page
     int h = 0;      // height on page
     int page = 0;   // page number
+    int blockX = 0;     // top left of the rect in pb_scaledSDF that went on the page
+    int blockY = 0;
     int xoffset = 0;    // offset from draw pos to bottom left render pos
     int yoffset = 0;    // offset from draw pos to bottom left render pos
     int advance = 0;    // how much to advance x pos after drawing this char
@@ -0,0 +1,80 @@
+#include "FontPool.h"
+#include "SDL3/SDL.h"
+
+#include <atomic>
+
+// every pool gets a unique id so a thread's cached font can't be mistaken for one from a deleted pool at the same address
+static std::atomic<u64> g_nextPoolId{ 1 };
+
+// the font this thread opened and the file copy it reads from
+struct ThreadFontCache
+{
+    u64 poolId = 0;
+    TTF_Font* font = nullptr;
+    std::shared_ptr<void> data;
+
+    ~ThreadFontCache()
+    {
+        Close();
+    }
+
+    void Close()
+    {
+        if (font)
+            TTF_CloseFont(font);
+        font = nullptr;
+        data = nullptr;
+        poolId = 0;
+    }
+};
+static thread_local ThreadFontCache t_fontCache;
+
+FontPool::FontPool(const std::string& path, float ptsize, bool sdf)
+{
+    m_id = g_nextPoolId++;
+    m_ptsize = ptsize;
+    m_sdf = sdf;
+
+    // read the file once, every handle reads from this copy
+    m_data = std::shared_ptr<void>(SDL_LoadFile(path.c_str(), &m_size), SDL_free);
+    if (!m_data)
+    {
+        SDL_Log("FontPool: can't load %s : %s", path.c_str(), SDL_GetError());
+        return;
+    }
+
+    // make sure the data really is a font before any worker relies on it
+    TTF_Font* font = OpenFont();
+    if (!font)
+    {
+        SDL_Log("FontPool: can't open %s : %s", path.c_str(), SDL_GetError());
+        m_data = nullptr;
+        return;
+    }
+    TTF_CloseFont(font);
+}
+
+TTF_Font* FontPool::OpenFont() const
+{
+    SDL_IOStream* io = SDL_IOFromConstMem(m_data.get(), m_size);
+    TTF_Font* font = io ? TTF_OpenFontIO(io, true, m_ptsize) : nullptr;
+    if (font)
+        TTF_SetFontSDF(font, m_sdf);
+    return font;
+}
+
+TTF_Font* FontPool::ThreadFont()
+{
+    if (t_fontCache.poolId == m_id)
+        return t_fontCache.font;
+
+    if (!m_data)
+        return nullptr;
+
+    // the font held now was opened on this thread, so this is where it gets closed
+    t_fontCache.Close();
+    t_fontCache.poolId = m_id;
+    t_fontCache.font = OpenFont();
+    t_fontCache.data = m_data;
+    return t_fontCache.font;
+}
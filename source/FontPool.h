@@ -0,0 +1,31 @@
+#pragma once
+
+#include "types.h"
+#include <memory>
+#include <string>
+#include "SDL3/SDL_ttf.h"
+
+// one TTF_Font per worker thread over a single in memory copy of the font file
+// SDL_ttf fonts can't be shared between threads, so with one font every glyph raster had to take a lock
+// SDL_ttf also wants a font closed on the thread that opened it, so each thread closes its own font
+// when it next needs another pool's font or exits - the file copy stays alive until the last of them is closed
+class FontPool
+{
+public:
+    FontPool(const std::string& path, float ptsize, bool sdf);
+
+    bool IsValid() const { return m_data != nullptr; }
+
+    // the calling thread's font, opened on first use - no lock at all
+    // returns nullptr if the font data can't be opened
+    TTF_Font* ThreadFont();
+
+private:
+    TTF_Font* OpenFont() const;
+
+    u64 m_id = 0;
+    std::shared_ptr<void> m_data;
+    size_t m_size = 0;
+    float m_ptsize = 0.0f;
+    bool m_sdf = false;
+};
@@ -0,0 +1,594 @@
+#include "GlyphRaster.h"
+#include "PixelBlock.h"
+#include "Trace.h"
+#include "SDL3/SDL.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <vector>
+
+// a private copy of the implementation - imgui's is static to imgui_draw.cpp
+#define STBTT_STATIC
+#define STB_TRUETYPE_IMPLEMENTATION
+#include "imstb_truetype.h"
+
+GlyphRaster::GlyphRaster(const std::string& path)
+{
+    size_t size = 0;
+    m_data = (u8*)SDL_LoadFile(path.c_str(), &size);
+    if (!m_data)
+    {
+        SDL_Log("GlyphRaster: can't load %s : %s", path.c_str(), SDL_GetError());
+        return;
+    }
+
+    m_info = new stbtt_fontinfo;
+    if (!stbtt_InitFont(m_info, m_data, stbtt_GetFontOffsetForIndex(m_data, 0)))
+    {
+        SDL_Log("GlyphRaster: %s isn't a font stb_truetype can read", path.c_str());
+        delete m_info;
+        m_info = nullptr;
+    }
+}
+
+GlyphRaster::~GlyphRaster()
+{
+    delete m_info;
+    SDL_free(m_data);
+}
+
+bool GlyphRaster::HasGlyph(u32 ch) const
+{
+    return stbtt_FindGlyphIndex(m_info, (int)ch) != 0;
+}
+
+void GlyphRaster::GlyphBox(u32 ch, float size, int& w, int& h) const
+{
+    float scale = stbtt_ScaleForMappingEmToPixels(m_info, size);
+    int x0, y0, x1, y1;
+    stbtt_GetCodepointBitmapBox(m_info, (int)ch, scale, scale, &x0, &y0, &x1, &y1);
+    w = x1 - x0;
+    h = y1 - y0;
+}
+
+void GlyphRaster::GlyphOrigin(u32 ch, float size, int padding, int& originX, int& baseline) const
+{
+    Layout layout;
+    int advance;
+    CalcLayout(ch, size, padding, layout, advance);
+    originX = layout.originX;
+    baseline = layout.baseline;
+}
+
+float GlyphRaster::EstimateCost(u32 ch, float size) const
+{
+    int w, h;
+    GlyphBox(ch, size, w, h);
+    return (float)std::max(w * h, 1);
+}
+
+void GlyphRaster::CalcLayout(u32 ch, float size, int padding, Layout& layout, int& advance) const
+{
+    layout.scale = stbtt_ScaleForMappingEmToPixels(m_info, size);
+
+    int ascent, descent, lineGap;
+    stbtt_GetFontVMetrics(m_info, &ascent, &descent, &lineGap);
+    int advanceUnits, lsb;
+    stbtt_GetCodepointHMetrics(m_info, (int)ch, &advanceUnits, &lsb);
+    advance = (int)lroundf(advanceUnits * layout.scale);
+
+    stbtt_GetCodepointBitmapBox(m_info, (int)ch, layout.scale, layout.scale, &layout.x0, &layout.y0, &layout.x1, &layout.y1);
+
+    // grow the block past the font's ascent, descent and advance for glyphs that poke out of them
+    layout.originX = std::max(-layout.x0, 0) + padding;
+    layout.baseline = std::max((int)ceilf(ascent * layout.scale), -layout.y0) + padding;
+    layout.width = layout.originX + std::max(advance, layout.x1) + padding;
+    layout.height = layout.baseline + std::max((int)ceilf(-descent * layout.scale), layout.y1) + padding;
+}
+
+void GlyphRaster::Render(u32 ch, float size, PixelBlock& pb, int& advance) const
+{
+    TraceScope trace("raster");
+    Layout layout;
+    CalcLayout(ch, size, 0, layout, advance);
+    pb.Allocate(std::max(layout.width, 1), std::max(layout.height, 1), PixelFormat::A8);
+    memset(pb.pixels, 0, pb.pitch * pb.h);
+
+    // coverage goes directly into the block - only the glyph box is written
+    if (layout.x1 > layout.x0 && layout.y1 > layout.y0)
+    {
+        u8* dest = pb.Row(layout.baseline + layout.y0) + layout.originX + layout.x0;
+        stbtt_MakeCodepointBitmap(m_info, dest, layout.x1 - layout.x0, layout.y1 - layout.y0, pb.pitch, layout.scale, layout.scale, (int)ch);
+    }
+}
+
+// MSDF edge colours - a bit per channel, every edge has at least two so the median of a pixel's channels is the true side
+enum EdgeColour : u8
+{
+    EdgeBlue = 1,
+    EdgeGreen = 2,
+    EdgeRed = 4,
+    EdgeCyan = EdgeGreen | EdgeBlue,
+    EdgeMagenta = EdgeRed | EdgeBlue,
+    EdgeYellow = EdgeRed | EdgeGreen,
+    EdgeWhite = EdgeRed | EdgeGreen | EdgeBlue
+};
+
+// one line (2 points), quadratic (3) or cubic (4) of a contour, in block pixels with y down
+struct OutlineEdge
+{
+    int points;
+    float x[4];
+    float y[4];
+    u8 colour;
+};
+
+// an edge flattened into lines - edgeStart/edgeEnd mark the ends of the original edge for the MSDF pseudo distance
+struct OutlineSegment
+{
+    float x0, y0, x1, y1;
+    u8 colour;
+    bool edgeStart;
+    bool edgeEnd;
+};
+
+// curves are split into lines no further than this from the true curve, in output pixels - well under one SDF step
+static const float OutlineTolerance = 1.0f / 64.0f;
+
+// stb's shape for ch as closed contours in block pixels
+static void GetContours(const stbtt_fontinfo* info, u32 ch, float scale, float ox, float oy, std::vector<std::vector<OutlineEdge>>& contours)
+{
+    stbtt_vertex* verts = nullptr;
+    int vertCount = stbtt_GetCodepointShape(info, (int)ch, &verts);
+    float startX = 0, startY = 0, penX = 0, penY = 0;
+    auto closeContour = [&]()
+        {
+            if (!contours.empty() && (penX != startX || penY != startY))
+                contours.back().push_back({ 2, { penX, startX }, { penY, startY }, EdgeWhite });
+        };
+    for (int i = 0; i < vertCount; i++)
+    {
+        const stbtt_vertex& v = verts[i];
+        float x = ox + v.x * scale;
+        float y = oy - v.y * scale;
+        switch (v.type)
+        {
+            case STBTT_vmove:
+                closeContour();
+                contours.emplace_back();
+                startX = x;
+                startY = y;
+                break;
+            case STBTT_vline:
+                if (x != penX || y != penY)
+                    contours.back().push_back({ 2, { penX, x }, { penY, y }, EdgeWhite });
+                break;
+            case STBTT_vcurve:
+                contours.back().push_back({ 3, { penX, ox + v.cx * scale, x }, { penY, oy - v.cy * scale, y }, EdgeWhite });
+                break;
+            case STBTT_vcubic:
+                contours.back().push_back({ 4, { penX, ox + v.cx * scale, ox + v.cx1 * scale, x }, { penY, oy - v.cy * scale, oy - v.cy1 * scale, y }, EdgeWhite });
+                break;
+        }
+        penX = x;
+        penY = y;
+    }
+    closeContour();
+    stbtt_FreeShape(info, verts);
+}
+
+// unit direction the edge leaves its first point / arrives at its last point
+static void EdgeStartDir(const OutlineEdge& e, float& dx, float& dy)
+{
+    int i = 1;
+    while (i < e.points - 1 && e.x[i] == e.x[0] && e.y[i] == e.y[0])
+        i++;
+    dx = e.x[i] - e.x[0];
+    dy = e.y[i] - e.y[0];
+    float len = sqrtf(dx * dx + dy * dy);
+    if (len > 0.0f)
+    {
+        dx /= len;
+        dy /= len;
+    }
+}
+
+static void EdgeEndDir(const OutlineEdge& e, float& dx, float& dy)
+{
+    int last = e.points - 1;
+    int i = last - 1;
+    while (i > 0 && e.x[i] == e.x[last] && e.y[i] == e.y[last])
+        i--;
+    dx = e.x[last] - e.x[i];
+    dy = e.y[last] - e.y[i];
+    float len = sqrtf(dx * dx + dy * dy);
+    if (len > 0.0f)
+    {
+        dx /= len;
+        dy /= len;
+    }
+}
+
+static u8 NextColour(u8 colour, u8 banned)
+{
+    do
+    {
+        colour = colour == EdgeCyan ? EdgeMagenta : colour == EdgeMagenta ? EdgeYellow : EdgeCyan;
+    } while (colour == banned);
+    return colour;
+}
+
+// simple edge colouring - edges either side of a sharp corner never share a colour, so the corner survives in the channels
+// a smooth contour stays white, a single corner splits its contour into thirds, more corners cycle colours between them
+static void ColourEdges(std::vector<std::vector<OutlineEdge>>& contours)
+{
+    // msdfgen's 3 radian threshold - directions whose cross product is over sin(3), about 0.14 or 8 degrees, make a corner
+    const float cornerCross = sinf(3.0f);
+    for (auto& edges : contours)
+    {
+        int n = (int)edges.size();
+        std::vector<int> corners;
+        for (int i = 0; i < n; i++)
+        {
+            float ax, ay, bx, by;
+            EdgeEndDir(edges[(i + n - 1) % n], ax, ay);
+            EdgeStartDir(edges[i], bx, by);
+            if (ax * bx + ay * by <= 0.0f || fabsf(ax * by - ay * bx) > cornerCross)
+                corners.push_back(i);
+        }
+
+        if (corners.empty() || (corners.size() == 1 && n < 3))
+        {
+            // nothing to keep sharp - too few edges to split a lone corner is left round
+            for (auto& e : edges)
+                e.colour = EdgeWhite;
+        }
+        else if (corners.size() == 1)
+        {
+            const u8 colours[3] = { EdgeCyan, EdgeWhite, EdgeMagenta };
+            for (int i = 0; i < n; i++)
+                edges[(corners[0] + i) % n].colour = colours[std::min(i * 3 / n, 2)];
+        }
+        else
+        {
+            int spline = 0;
+            u8 initial = EdgeCyan;
+            u8 colour = initial;
+            for (int i = 0; i < n; i++)
+            {
+                int index = (corners[0] + i) % n;
+                if (spline + 1 < (int)corners.size() && corners[spline + 1] == index)
+                {
+                    spline++;
+                    colour = NextColour(colour, spline == (int)corners.size() - 1 ? initial : 0);
+                }
+                edges[index].colour = colour;
+            }
+        }
+    }
+}
+
+static void AddLine(std::vector<OutlineSegment>& segs, float x0, float y0, float x1, float y1, u8 colour, bool edgeStart, bool edgeEnd)
+{
+    if (x0 != x1 || y0 != y1)
+        segs.push_back({ x0, y0, x1, y1, colour, edgeStart, edgeEnd });
+}
+
+// uniform steps - the error of n steps is bounded by the curve's second difference / n^2
+static int CurveSteps(float ddx, float ddy, float factor)
+{
+    float dd = sqrtf(ddx * ddx + ddy * ddy);
+    return std::clamp((int)ceilf(sqrtf(dd * factor / OutlineTolerance)), 1, 256);
+}
+
+static void FlattenEdge(std::vector<OutlineSegment>& segs, const OutlineEdge& e)
+{
+    if (e.points == 2)
+    {
+        AddLine(segs, e.x[0], e.y[0], e.x[1], e.y[1], e.colour, true, true);
+        return;
+    }
+
+    int steps;
+    if (e.points == 3)
+    {
+        steps = CurveSteps(e.x[0] - 2 * e.x[1] + e.x[2], e.y[0] - 2 * e.y[1] + e.y[2], 0.125f);
+    }
+    else
+    {
+        float ddx = std::max(fabsf(e.x[0] - 2 * e.x[1] + e.x[2]), fabsf(e.x[1] - 2 * e.x[2] + e.x[3]));
+        float ddy = std::max(fabsf(e.y[0] - 2 * e.y[1] + e.y[2]), fabsf(e.y[1] - 2 * e.y[2] + e.y[3]));
+        steps = CurveSteps(ddx, ddy, 0.75f);
+    }
+
+    float px = e.x[0], py = e.y[0];
+    for (int i = 1; i <= steps; i++)
+    {
+        float t = (float)i / steps;
+        float u = 1.0f - t;
+        float nx, ny;
+        if (e.points == 3)
+        {
+            nx = u * u * e.x[0] + 2 * u * t * e.x[1] + t * t * e.x[2];
+            ny = u * u * e.y[0] + 2 * u * t * e.y[1] + t * t * e.y[2];
+        }
+        else
+        {
+            nx = u * u * u * e.x[0] + 3 * u * u * t * e.x[1] + 3 * u * t * t * e.x[2] + t * t * t * e.x[3];
+            ny = u * u * u * e.y[0] + 3 * u * u * t * e.y[1] + 3 * u * t * t * e.y[2] + t * t * t * e.y[3];
+        }
+        AddLine(segs, px, py, nx, ny, e.colour, i == 1, i == steps);
+        px = nx;
+        py = ny;
+    }
+}
+
+static void FlattenContours(const std::vector<std::vector<OutlineEdge>>& contours, std::vector<OutlineSegment>& segs)
+{
+    for (auto& edges : contours)
+        for (auto& e : edges)
+            FlattenEdge(segs, e);
+}
+
+// grid of cellSize square cells listing every segment that can be within range of the cell - each pixel only tests its own cell's list
+static const int OutlineCellSize = 8;
+
+static void BuildSegmentGrid(const std::vector<OutlineSegment>& segs, int w, int h, int range, std::vector<std::vector<int>>& cells, int& cellsW)
+{
+    cellsW = (w + OutlineCellSize - 1) / OutlineCellSize;
+    int cellsH = (h + OutlineCellSize - 1) / OutlineCellSize;
+    cells.assign(cellsW * cellsH, {});
+    for (int i = 0; i < (int)segs.size(); i++)
+    {
+        const OutlineSegment& s = segs[i];
+        int cx0 = std::max((int)floorf((std::min(s.x0, s.x1) - range) / OutlineCellSize), 0);
+        int cx1 = std::min((int)floorf((std::max(s.x0, s.x1) + range) / OutlineCellSize), cellsW - 1);
+        int cy0 = std::max((int)floorf((std::min(s.y0, s.y1) - range) / OutlineCellSize), 0);
+        int cy1 = std::min((int)floorf((std::max(s.y0, s.y1) + range) / OutlineCellSize), cellsH - 1);
+        for (int cy = cy0; cy <= cy1; cy++)
+            for (int cx = cx0; cx <= cx1; cx++)
+                cells[cy * cellsW + cx].push_back(i);
+    }
+}
+
+// non zero winding along the row through py - crossings sorted by x, each adds its direction
+static void RowCrossings(const std::vector<OutlineSegment>& segs, float py, std::vector<std::pair<float, int>>& crossings)
+{
+    crossings.clear();
+    for (const OutlineSegment& s : segs)
+    {
+        if ((s.y0 <= py && py < s.y1) || (s.y1 <= py && py < s.y0))
+            crossings.push_back({ s.x0 + (py - s.y0) * (s.x1 - s.x0) / (s.y1 - s.y0), s.y1 > s.y0 ? 1 : -1 });
+    }
+    std::sort(crossings.begin(), crossings.end());
+}
+
+static u8 EncodeOutlineDistance(float dist, int range)
+{
+    return (u8)std::clamp((int)lroundf(128.0f + dist * 128.0f / range), 0, 255);
+}
+
+static float SegmentDistSq(const OutlineSegment& s, float px, float py)
+{
+    float dx = s.x1 - s.x0;
+    float dy = s.y1 - s.y0;
+    float t = ((px - s.x0) * dx + (py - s.y0) * dy) / (dx * dx + dy * dy);
+    t = std::clamp(t, 0.0f, 1.0f);
+    float ex = s.x0 + t * dx - px;
+    float ey = s.y0 + t * dy - py;
+    return ex * ex + ey * ey;
+}
+
+void GlyphRaster::RenderSDF(u32 ch, float size, int range, PixelBlock& pb, int& advance) const
+{
+    TraceScope trace("sdf");
+    range = std::max(range, 1);
+    Layout layout;
+    CalcLayout(ch, size, range, layout, advance);
+    pb.Allocate(std::max(layout.width, 1), std::max(layout.height, 1), PixelFormat::A8);
+    memset(pb.pixels, 0, pb.pitch * pb.h);
+
+    std::vector<std::vector<OutlineEdge>> contours;
+    GetContours(m_info, ch, layout.scale, (float)layout.originX, (float)layout.baseline, contours);
+    std::vector<OutlineSegment> segs;
+    FlattenContours(contours, segs);
+    if (segs.empty())
+        return;
+
+    std::vector<std::vector<int>> cells;
+    int cellsW;
+    BuildSegmentGrid(segs, pb.w, pb.h, range, cells, cellsW);
+
+    const float rangeSq = (float)(range * range);
+    std::vector<std::pair<float, int>> crossings;
+    for (int y = 0; y < pb.h; y++)
+    {
+        float py = y + 0.5f;
+        RowCrossings(segs, py, crossings);
+
+        u8* out = pb.Row(y);
+        size_t next = 0;
+        int winding = 0;
+        for (int x = 0; x < pb.w; x++)
+        {
+            float px = x + 0.5f;
+            while (next < crossings.size() && crossings[next].first < px)
+                winding += crossings[next++].second;
+
+            float bestSq = rangeSq;
+            for (int i : cells[(y / OutlineCellSize) * cellsW + x / OutlineCellSize])
+                bestSq = std::min(bestSq, SegmentDistSq(segs[i], px, py));
+
+            float dist = sqrtf(bestSq);
+            out[x] = EncodeOutlineDistance(winding != 0 ? dist : -dist, range);
+        }
+    }
+}
+
+void GlyphRaster::RenderMSDF(u32 ch, float size, int range, PixelBlock& pb, int& advance) const
+{
+    TraceScope trace("msdf");
+    range = std::max(range, 1);
+    Layout layout;
+    CalcLayout(ch, size, range, layout, advance);
+    pb.Allocate(std::max(layout.width, 1), std::max(layout.height, 1), PixelFormat::ARGB8888);
+    memset(pb.pixels, 0, pb.pitch * pb.h);
+
+    std::vector<std::vector<OutlineEdge>> contours;
+    GetContours(m_info, ch, layout.scale, (float)layout.originX, (float)layout.baseline, contours);
+    ColourEdges(contours);
+    std::vector<OutlineSegment> segs;
+    FlattenContours(contours, segs);
+    if (segs.empty())
+        return;
+
+    std::vector<std::vector<int>> cells;
+    int cellsW;
+    BuildSegmentGrid(segs, pb.w, pb.h, range, cells, cellsW);
+
+    // which side of a segment is inside depends on the font's contour direction - the overall signed area tells us
+    float area = 0.0f;
+    for (const OutlineSegment& s : segs)
+        area += s.x0 * s.y1 - s.x1 * s.y0;
+    const float insideSide = area > 0.0f ? 1.0f : -1.0f;
+
+    const float rangeSq = (float)(range * range);
+    std::vector<std::pair<float, int>> crossings;
+    for (int y = 0; y < pb.h; y++)
+    {
+        float py = y + 0.5f;
+        RowCrossings(segs, py, crossings);
+
+        u32* out = pb.Row32(y);
+        size_t next = 0;
+        int winding = 0;
+        for (int x = 0; x < pb.w; x++)
+        {
+            float px = x + 0.5f;
+            while (next < crossings.size() && crossings[next].first < px)
+                winding += crossings[next++].second;
+            bool inside = winding != 0;
+
+            // nearest segment overall for alpha, and per channel for RGB
+            // ties between segments meeting at a point go to the one the pixel is most square on to
+            float bestSq = rangeSq;
+            float channelSq[3] = { FLT_MAX, FLT_MAX, FLT_MAX };
+            float channelOrtho[3] = { 0.0f, 0.0f, 0.0f };
+            int channelSeg[3] = { -1, -1, -1 };
+            for (int i : cells[(y / OutlineCellSize) * cellsW + x / OutlineCellSize])
+            {
+                const OutlineSegment& s = segs[i];
+                float dx = s.x1 - s.x0;
+                float dy = s.y1 - s.y0;
+                float len = sqrtf(dx * dx + dy * dy);
+                float t = std::clamp(((px - s.x0) * dx + (py - s.y0) * dy) / (len * len), 0.0f, 1.0f);
+                float ex = px - (s.x0 + t * dx);
+                float ey = py - (s.y0 + t * dy);
+                float distSq = ex * ex + ey * ey;
+                bestSq = std::min(bestSq, distSq);
+
+                float ortho = distSq > 0.0f ? fabsf(dx * ey - dy * ex) / (len * sqrtf(distSq)) : 1.0f;
+                for (int c = 0; c < 3; c++)
+                {
+                    if (!(s.colour & (EdgeRed >> c)))
+                        continue;
+                    if (distSq < channelSq[c] - 1e-6f || (distSq <= channelSq[c] + 1e-6f && ortho > channelOrtho[c]))
+                    {
+                        channelSq[c] = distSq;
+                        channelOrtho[c] = ortho;
+                        channelSeg[c] = i;
+                    }
+                }
+            }
+
+            // signed pseudo distance per channel - past the end of an edge the distance is to the edge's extended line
+            float channelDist[3];
+            for (int c = 0; c < 3; c++)
+            {
+                if (channelSeg[c] < 0)
+                {
+                    channelDist[c] = inside ? (float)range : -(float)range;
+                    continue;
+                }
+                const OutlineSegment& s = segs[channelSeg[c]];
+                float dx = s.x1 - s.x0;
+                float dy = s.y1 - s.y0;
+                float len = sqrtf(dx * dx + dy * dy);
+                float along = ((px - s.x0) * dx + (py - s.y0) * dy) / (len * len);
+                float side = (dx * (py - s.y0) - dy * (px - s.x0)) / len * insideSide;
+                float dist = sqrtf(channelSq[c]);
+                if ((along < 0.0f && s.edgeStart) || (along > 1.0f && s.edgeEnd))
+                    channelDist[c] = fabsf(side) <= dist ? side : (side >= 0.0f ? dist : -dist);
+                else
+                    channelDist[c] = side >= 0.0f ? dist : -dist;
+            }
+
+            // where the channels would put the pixel on the wrong side, fall back to the true distance in all three
+            float dist = sqrtf(bestSq);
+            float trueDist = inside ? dist : -dist;
+            float median = std::max(std::min(channelDist[0], channelDist[1]), std::min(std::max(channelDist[0], channelDist[1]), channelDist[2]));
+            if ((median >= 0.0f) != inside)
+                channelDist[0] = channelDist[1] = channelDist[2] = trueDist;
+
+            out[x] = (u32)EncodeOutlineDistance(trueDist, range) << 24 | (u32)EncodeOutlineDistance(channelDist[0], range) << 16 |
+                (u32)EncodeOutlineDistance(channelDist[1], range) << 8 | EncodeOutlineDistance(channelDist[2], range);
+        }
+    }
+}
+
+void GlyphRaster::RenderPreviewMSDF(u32 ch, float size, int range, PixelBlock& pb, int& advance) const
+{
+    PixelBlock sdf;
+    RenderSupersampledSDF(ch, size, range, 1, SDFEngine::RowScan, ResampleFilter::Box, sdf, advance);
+    pb.Allocate(sdf.w, sdf.h, PixelFormat::ARGB8888);
+    for (int y = 0; y < sdf.h; y++)
+    {
+        const u8* in = sdf.Row(y);
+        u32* out = pb.Row32(y);
+        for (int x = 0; x < sdf.w; x++)
+            out[x] = in[x] * 0x01010101u;
+    }
+    sdf.Free();
+}
+
+int GlyphRaster::ClampSupersample(int range, int supersample)
+{
+    return std::clamp(supersample, 1, std::max(SDFMaxRange / std::max(range, 1), 1));
+}
+
+void GlyphRaster::RenderSupersampledSDF(u32 ch, float size, int range, int supersample, SDFEngine engine, ResampleFilter filter, PixelBlock& pb, int& advance) const
+{
+    range = std::max(range, 1);
+    supersample = ClampSupersample(range, supersample);
+    Layout layout;
+    CalcLayout(ch, size, range, layout, advance);
+    pb.Allocate(std::max(layout.width, 1), std::max(layout.height, 1), PixelFormat::A8);
+    memset(pb.pixels, 0, pb.pitch * pb.h);
+
+    // the raster block is exactly the output block scaled up, pen and baseline included, so the filter lines up
+    // the glyph box at the larger scale always fits inside the scaled up box of the output layout
+    float scale = layout.scale * supersample;
+    int x0, y0, x1, y1;
+    stbtt_GetCodepointBitmapBox(m_info, (int)ch, scale, scale, &x0, &y0, &x1, &y1);
+    if (x1 <= x0 || y1 <= y0)
+        return;
+
+    PixelBlock source;
+    {
+        TraceScope trace("raster");
+        source.Allocate(pb.w * supersample, pb.h * supersample, PixelFormat::A8);
+        memset(source.pixels, 0, source.pitch * source.h);
+        u8* dest = source.Row(layout.baseline * supersample + y0) + layout.originX * supersample + x0;
+        stbtt_MakeCodepointBitmap(m_info, dest, x1 - x0, y1 - y0, source.pitch, scale, scale, (int)ch);
+        source.CalcCropRect();
+    }
+
+    if (source.crop_w > 0 && !JobCancelled())
+    {
+        PixelBlockDistanceFinder df;
+        df.Generate(source);
+        pb.GenerateScaledSDF(source, df, range * supersample, filter, 4, engine);
+    }
+    source.Free();
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include "types.h"
+#include <string>
+
+struct PixelBlock;
+struct stbtt_fontinfo;
+enum class SDFEngine;
+enum class ResampleFilter;
+
+// glyph coverage straight into A8 pixel blocks using the stb_truetype that comes with imgui
+// the font data and info are read only after loading so one GlyphRaster can be shared by every worker
+class GlyphRaster
+{
+public:
+    GlyphRaster(const std::string& path);
+    ~GlyphRaster();
+
+    bool IsValid() const { return m_info != nullptr; }
+    bool HasGlyph(u32 ch) const;
+
+    // relative cost of an SDF for ch at 'size' from the glyph box area, without rendering
+    // the contour count was tried as a factor too but tracks the time of every engine worse than the area alone
+    float EstimateCost(u32 ch, float size) const;
+    // size in pixels of the inked box of ch at 'size', from the outline alone
+    void GlyphBox(u32 ch, float size, int& w, int& h) const;
+    // pen position and baseline row of ch in the block a render makes - padding is 0 for Render, range for the SDF renders
+    void GlyphOrigin(u32 ch, float size, int padding, int& originX, int& baseline) const;
+
+    // renders ch at 'size' pixels per em (the same as an SDL_ttf point size) into pb, resizing it to fit
+    // the block is laid out like an SDL_ttf glyph surface - baseline at the font ascent, x = 0 at the pen position
+    // glyphs with no outline, like space, give an empty block - advance is always filled in
+    void Render(u32 ch, float size, PixelBlock& pb, int& advance) const;
+
+    // signed distance straight from the glyph outline at 'size', no raster or supersample - A8, 128 on the edge, inside positive
+    // range is in output pixels and the block gets that much padding on every side, otherwise laid out like Render
+    void RenderSDF(u32 ch, float size, int range, PixelBlock& pb, int& advance) const;
+
+    // multi channel SDF into an ARGB block - edge coloured distances in RGB keep corners sharp through median(r, g, b)
+    // alpha holds the plain SDF, same encoding and layout as RenderSDF
+    void RenderMSDF(u32 ch, float size, int range, PixelBlock& pb, int& advance) const;
+
+    // quick stand in for RenderMSDF with the same layout - a 1x raster SDF in every channel, so median(r, g, b) is a plain SDF with round corners
+    void RenderPreviewMSDF(u32 ch, float size, int range, PixelBlock& pb, int& advance) const;
+
+    // SDF from a coverage raster 'supersample' times larger in each direction, searched with 'engine' and scaled down with 'filter'
+    // the per pixel engines only search 4x4 samples per output pixel, Coverage needs the whole raster
+    // same layout as RenderSDF - supersample is limited so the raster range stays within SDFMaxRange
+    void RenderSupersampledSDF(u32 ch, float size, int range, int supersample, SDFEngine engine, ResampleFilter filter, PixelBlock& pb, int& advance) const;
+
+    // the supersample RenderSupersampledSDF actually uses for an output range
+    static int ClampSupersample(int range, int supersample);
+
+private:
+    struct Layout
+    {
+        float scale;
+        int x0, y0, x1, y1;     // glyph box relative to the pen, y down
+        int originX;            // pen position in the block
+        int baseline;
+        int width;
+        int height;
+    };
+    void CalcLayout(u32 ch, float size, int padding, Layout& layout, int& advance) const;
+
+    u8* m_data = nullptr;
+    stbtt_fontinfo* m_info = nullptr;
+};
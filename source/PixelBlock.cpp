@@ -1,6 +1,8 @@
 #include "PixelBlock.h"
 #include "math.h"
 #include "types.h"
+#include "Simd.h"
+#include "Trace.h"
 #include "SDL3/SDL.h"
 
 #include <cstdint>
@@ -14,6 +16,9 @@
 #include <memory>
 #include <string>
 #include <format>
+#include <bit>
+#include <atomic>
+#include <mutex>
 
 #include <cmath>
 #include <cstdint>
@@ -32,199 +37,819 @@ struct PosCheck
     float dist;
 };
 
-std::vector<PosCheck> g_posChecks;
+// offset tables sorted by distance, one per SDF range - built on first use and kept for the life of the app
+static std::atomic<std::vector<PosCheck>*> g_posChecks[SDFMaxRange + 1];
+static std::mutex g_posChecksAccess;
 
-void InitPosCheckArray()
+static int ClampRange(int range)
+{
+    return std::clamp(range, 1, SDFMaxRange);
+}
+
+static const std::vector<PosCheck>& GetPosChecks(int range)
 {
-    for (int yo = -32; yo <= 32; yo++)
+    range = ClampRange(range);
+    std::vector<PosCheck>* checks = g_posChecks[range].load(std::memory_order_acquire);
+    if (checks)
+        return *checks;
+
+    std::lock_guard<std::mutex> lock(g_posChecksAccess);
+    checks = g_posChecks[range].load(std::memory_order_relaxed);
+    if (checks)
+        return *checks;
+
+    checks = new std::vector<PosCheck>;
+    for (int yo = -range; yo <= range; yo++)
     {
-        for (int xo = -32; xo <= 32; xo++)
+        for (int xo = -range; xo <= range; xo++)
         {
             if (xo == 0 && yo == 0)
                 continue;
 
-            float dist = (int)sqrtf((float)(xo * xo + yo * yo)) / 32.0f * 127.0f;
+            float dist = (int)sqrtf((float)(xo * xo + yo * yo)) / (float)range * 127.0f;
             if (dist < 128.0f)
             {
-                g_posChecks.emplace_back(xo, yo, dist);
+                checks->emplace_back(xo, yo, dist);
             }
         }
     }
 
-    std::sort(g_posChecks.begin(), g_posChecks.end(), [](const PosCheck& a, const PosCheck& b)->bool { return a.dist < b.dist; });
+    std::sort(checks->begin(), checks->end(), [](const PosCheck& a, const PosCheck& b)->bool { return a.dist < b.dist; });
+    g_posChecks[range].store(checks, std::memory_order_release);
+    return *checks;
 }
 
-void PixelBlock::ScaleCropped(const PixelBlock& source)
+void InitPosCheckArray()
+{
+    // the default range is nearly always wanted so build it up front
+    GetPosChecks(SDFDefaultRange);
+}
+
+void PixelBlock::Allocate(int width, int height, PixelFormat pixelFormat)
+{
+    delete[] pixels;
+    format = pixelFormat;
+    w = width;
+    h = height;
+    pitch = w * BytesPerPixel();
+    pixels = new u8[pitch * h];
+}
+
+void PixelBlock::Free()
+{
+    delete[] pixels;
+    pixels = nullptr;
+    w = 0;
+    h = 0;
+    pitch = 0;
+}
+
+void PixelBlock::ScaleCropped(const PixelBlock& source, ResampleFilter filter)
 {
     if (source.crop_w == 0 || source.crop_h == 0)
         return;
 
-    // scale source crop_x..crop_x+crop_w, crop_y..crop_y+crop_w  =>  w,h
-    for (int y = 0; y < h; y++)
-    {
-        for (int x = 0; x < w; x++)
-        {
-            int x1 = x * source.crop_w / w + source.crop_x;
-            int x2 = (x + 1) * source.crop_w / w + source.crop_x;
-            int y1 = y * source.crop_h / h + source.crop_y;
-            int y2 = (y + 1) * source.crop_h / h + source.crop_y;
-            u32 accumA = 0;
-            u32 accumR = 0;
-            u32 accumG = 0;
-            u32 accumB = 0;
-            for (int yy = y1; yy < y2; yy++)
-            {
-                for (int xx = x1; xx < x2; xx++)
-                {
-                    u32 val = source.pixels[yy * source.pitch / 4 + xx];
-                    accumA += val >> 24;
-                    accumR += (val >> 16) & 0xff;
-                    accumG += (val >> 8) & 0xff;
-                    accumB += val & 0xff;
-                }
-            }
-            int area = (x2 - x1) * (y2 - y1);
-            accumA /= area;
-            accumR /= area;
-            accumG /= area;
-            accumB /= area;
-            pixels[y * pitch / 4 + x] = (accumA << 24) | (accumR << 16) | (accumG << 8) | (accumB);
-        }
-    }
+    // scale source crop_x..crop_x+crop_w, crop_y..crop_y+crop_h  =>  w,h
+    auto xAxis = GetResampleAxis(filter, source.crop_w, w);
+    auto yAxis = GetResampleAxis(filter, source.crop_h, h);
+    Resample(*this, source, source.crop_x, source.crop_y, *xAxis, *yAxis);
 }
 
-void PixelBlock::Scale(const PixelBlock& source)
+void PixelBlock::Scale(const PixelBlock& source, ResampleFilter filter)
 {
+    TraceScope trace("scale");
     if (source.w == 0 || source.h == 0)
         return;
 
-    // scale source crop_x..crop_x+crop_w, crop_y..crop_y+crop_w  =>  w,h
-    for (int y = 0; y < h; y++)
-    {
-        for (int x = 0; x < w; x++)
-        {
-            int x1 = x * source.w / w;
-            int x2 = (x + 1) * source.w / w;
-            int y1 = y * source.h / h;
-            int y2 = (y + 1) * source.h / h;
-            u32 accumA = 0;
-            u32 accumR = 0;
-            u32 accumG = 0;
-            u32 accumB = 0;
-            for (int yy = y1; yy < y2; yy++)
-            {
-                for (int xx = x1; xx < x2; xx++)
-                {
-                    u32 val = source.pixels[yy * source.pitch / 4 + xx];
-                    accumA += val >> 24;
-                    accumR += (val >> 16) & 0xff;
-                    accumG += (val >> 8) & 0xff;
-                    accumB += val & 0xff;
-                }
-            }
-            int area = (x2 - x1) * (y2 - y1);
-            accumA /= area;
-            accumR /= area;
-            accumG /= area;
-            accumB /= area;
-            pixels[y * pitch / 4 + x] = (accumA << 24) | (accumR << 16) | (accumG << 8) | (accumB);
-        }
-    }
+    auto xAxis = GetResampleAxis(filter, source.w, w);
+    auto yAxis = GetResampleAxis(filter, source.h, h);
+    Resample(*this, source, 0, 0, *xAxis, *yAxis);
 }
 
 void PixelBlock::CopyCropped(const PixelBlock& source, int x, int y)
 {
+    SDL_assert(source.format == format);
+
+    // clip the copied span to this block
+    int sx = source.crop_x + std::max(-x, 0);
+    int dx = std::max(x, 0);
+    int span = std::min(source.crop_x + source.crop_w - sx, w - dx);
+    if (span <= 0)
+        return;
+
+    int bpp = BytesPerPixel();
     for (int yy = 0; yy < source.crop_h; yy++)
     {
         int sy = source.crop_y + yy;
         int dy = y + yy;
         if (dy < 0 || dy >= h)
             continue;
-        for (int xx = 0; xx < source.crop_w; xx++)
+        memcpy(Row(dy) + dx * bpp, source.Row(sy) + sx * bpp, span * bpp);
+    }
+}
+
+// first pixel in x0..x1 (exclusive) with non zero alpha, or x1 if there isn't one - a whole vector of alphas per compare
+static int FirstOpaque(const u8* row, int x0, int x1, int bpp)
+{
+    int x = x0;
+    if (bpp == 1)
+    {
+#if defined(SIMD_AVX2)
+        for (; x + 32 <= x1; x += 32)
         {
-            int sx = source.crop_x + xx;
-            int dx = x + xx;
-            if (dx < 0 || dx >= w)
-                continue;
-            pixels[dy * pitch / 4 + dx] = source.pixels[sy * source.pitch / 4 + sx];
+            __m256i v = _mm256_loadu_si256((const __m256i*)(row + x));
+            u32 mask = ~(u32)_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, _mm256_setzero_si256()));
+            if (mask)
+                return x + std::countr_zero(mask);
+        }
+#elif defined(SIMD_SSE2)
+        for (; x + 16 <= x1; x += 16)
+        {
+            __m128i v = _mm_loadu_si128((const __m128i*)(row + x));
+            u32 mask = ~(u32)_mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_setzero_si128())) & 0xffff;
+            if (mask)
+                return x + std::countr_zero(mask);
         }
+#elif defined(SIMD_NEON)
+        for (; x + 16 <= x1; x += 16)
+        {
+            if (vmaxvq_u8(vld1q_u8(row + x)))
+                break;
+        }
+#endif
+        for (; x < x1; x++)
+            if (row[x])
+                return x;
+        return x1;
+    }
+
+    // ARGB - test the alpha byte of each pixel
+#if defined(SIMD_AVX2)
+    const __m256i alpha = _mm256_set1_epi32((int)0xff000000);
+    for (; x + 8 <= x1; x += 8)
+    {
+        __m256i v = _mm256_and_si256(_mm256_loadu_si256((const __m256i*)(row + x * 4)), alpha);
+        u32 mask = ~(u32)_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(v, _mm256_setzero_si256()))) & 0xff;
+        if (mask)
+            return x + std::countr_zero(mask);
     }
+#elif defined(SIMD_SSE2)
+    const __m128i alpha = _mm_set1_epi32((int)0xff000000);
+    for (; x + 4 <= x1; x += 4)
+    {
+        __m128i v = _mm_and_si128(_mm_loadu_si128((const __m128i*)(row + x * 4)), alpha);
+        u32 mask = ~(u32)_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(v, _mm_setzero_si128()))) & 0xf;
+        if (mask)
+            return x + std::countr_zero(mask);
+    }
+#elif defined(SIMD_NEON)
+    const uint32x4_t alpha = vdupq_n_u32(0xff000000);
+    for (; x + 4 <= x1; x += 4)
+    {
+        if (vmaxvq_u32(vandq_u32(vld1q_u32((const u32*)(row + x * 4)), alpha)))
+            break;
+    }
+#endif
+    for (; x < x1; x++)
+        if (row[x * 4 + 3])
+            return x;
+    return x1;
 }
 
-void PixelBlock::CalcCropRect()
+// last pixel in x0..x1 (exclusive) with non zero alpha, or x0 - 1 if there isn't one
+static int LastOpaque(const u8* row, int x0, int x1, int bpp)
 {
-    int xmin = w - 1;
-    int xmax = 0;
-    int ymin = h - 1;
-    int ymax = 0;
-    int wpitch = pitch / 4;
-    u32* base_p = pixels;
-    for (int yy = 0; yy < h; yy++)
+    int x = x1;
+    if (bpp == 1)
     {
-        u32* p = base_p;
-        for (int xx = 0; xx < w; xx++)
+#if defined(SIMD_AVX2)
+        for (; x - 32 >= x0; x -= 32)
         {
-            if (((*p++) & 0xff000000) != 0)
-            {
-                if (xx < xmin)
-                    xmin = xx;
-                if (xx > xmax)
-                    xmax = xx;
-                if (yy < ymin)
-                    ymin = yy;
-                if (yy > ymax)
-                    ymax = yy;
-            }
+            __m256i v = _mm256_loadu_si256((const __m256i*)(row + x - 32));
+            u32 mask = ~(u32)_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, _mm256_setzero_si256()));
+            if (mask)
+                return x - 32 + 31 - std::countl_zero(mask);
+        }
+#elif defined(SIMD_SSE2)
+        for (; x - 16 >= x0; x -= 16)
+        {
+            __m128i v = _mm_loadu_si128((const __m128i*)(row + x - 16));
+            u32 mask = ~(u32)_mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_setzero_si128())) & 0xffff;
+            if (mask)
+                return x - 16 + 31 - std::countl_zero(mask);
         }
-        base_p += wpitch;
+#elif defined(SIMD_NEON)
+        for (; x - 16 >= x0; x -= 16)
+        {
+            if (vmaxvq_u8(vld1q_u8(row + x - 16)))
+                break;
+        }
+#endif
+        for (x--; x >= x0; x--)
+            if (row[x])
+                return x;
+        return x0 - 1;
+    }
+
+#if defined(SIMD_AVX2)
+    const __m256i alpha = _mm256_set1_epi32((int)0xff000000);
+    for (; x - 8 >= x0; x -= 8)
+    {
+        __m256i v = _mm256_and_si256(_mm256_loadu_si256((const __m256i*)(row + (x - 8) * 4)), alpha);
+        u32 mask = ~(u32)_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(v, _mm256_setzero_si256()))) & 0xff;
+        if (mask)
+            return x - 8 + 31 - std::countl_zero(mask);
+    }
+#elif defined(SIMD_SSE2)
+    const __m128i alpha = _mm_set1_epi32((int)0xff000000);
+    for (; x - 4 >= x0; x -= 4)
+    {
+        __m128i v = _mm_and_si128(_mm_loadu_si128((const __m128i*)(row + (x - 4) * 4)), alpha);
+        u32 mask = ~(u32)_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(v, _mm_setzero_si128()))) & 0xf;
+        if (mask)
+            return x - 4 + 31 - std::countl_zero(mask);
+    }
+#elif defined(SIMD_NEON)
+    const uint32x4_t alpha = vdupq_n_u32(0xff000000);
+    for (; x - 4 >= x0; x -= 4)
+    {
+        if (vmaxvq_u32(vandq_u32(vld1q_u32((const u32*)(row + (x - 4) * 4)), alpha)))
+            break;
+    }
+#endif
+    for (x--; x >= x0; x--)
+        if (row[x * 4 + 3])
+            return x;
+    return x0 - 1;
+}
+
+void PixelBlock::CalcCropRect()
+{
+    crop_x = 0;
+    crop_y = 0;
+    crop_w = 0;
+    crop_h = 0;
+
+    // first and last rows with anything in them
+    const int bpp = BytesPerPixel();
+    int ymin = 0;
+    while (ymin < h && FirstOpaque(Row(ymin), 0, w, bpp) == w)
+        ymin++;
+    if (ymin == h)
+        return;
+    int ymax = h - 1;
+    while (FirstOpaque(Row(ymax), 0, w, bpp) == w)
+        ymax--;
+
+    // columns only within that band, and each row only needs checking outside the bounds found so far
+    int xmin = w;
+    int xmax = -1;
+    for (int yy = ymin; yy <= ymax; yy++)
+    {
+        const u8* row = Row(yy);
+        xmin = FirstOpaque(row, 0, xmin, bpp);
+        xmax = std::max(xmax, LastOpaque(row, std::max(xmax + 1, xmin), w, bpp));
+        if (xmin == 0 && xmax == w - 1)
+            break;
     }
+
     crop_x = xmin;
     crop_y = ymin;
     crop_w = xmax - xmin + 1;
     crop_h = ymax - ymin + 1;
+}
 
-    if (crop_w <= 0 || crop_h <= 0)
+// squared distances are clamped to this so sums can't overflow
+static const int EDTInfinity = 1 << 28;
+
+// convert a squared distance to the nearest opposite pixel into the signed -128..128 SDF range
+// matches the quantisation of the g_posChecks tables so every engine gives identical results
+// Range > 0 fixes the range at compile time, 0 uses 'range'
+template<int Range = 0>
+static int EncodeDistance(int distSq, bool pixOn, int range)
+{
+    if constexpr (Range > 0)
     {
-        crop_x = 0;
-        crop_y = 0;
-        crop_w = 0;
-        crop_h = 0;
+        // every distance that doesn't saturate fits in a small table - built once per range
+        struct Table
+        {
+            i16 on[(Range + 1) * (Range + 1)];
+            i16 off[(Range + 1) * (Range + 1)];
+            Table()
+            {
+                for (int d = 0; d < (Range + 1) * (Range + 1); d++)
+                {
+                    on[d] = (i16)EncodeDistance<0>(d, true, Range);
+                    off[d] = (i16)EncodeDistance<0>(d, false, Range);
+                }
+            }
+        };
+        static const Table table;
+        if (distSq >= (Range + 1) * (Range + 1))
+            return pixOn ? 128 : -128;
+        return pixOn ? table.on[distSq] : table.off[distSq];
     }
+
+    const float r = (float)(Range ? Range : range);
+    float dist = (int)sqrtf((float)distSq) / r * 127.0f;
+    if (dist >= 128.0f)
+        return pixOn ? 128 : -128;
+    return pixOn ? (int)(dist - 1.0f / r * 127.0f) : (int)-dist;
+}
+
+// signed distance in source pixels from the coverage engine into the same -128..128 range, the edge itself lands on 0
+static int EncodeCoverageDistance(float dist, int range)
+{
+    return std::clamp((int)floorf(dist / range * 127.0f + 0.5f), -128, 128);
 }
 
-void PixelBlock::GenerateSDF(const PixelBlock& source, const PixelBlockDistanceFinder &sourceDF, int range)
+template<SDFOutput Output>
+static u32 EncodeSDFPixel(int dist, u32 nx, u32 ny)
 {
-    int miny = std::max(source.crop_y - range, 0);
-    int maxy = std::min(source.crop_y + source.crop_h, h);
-    int minx = std::max(source.crop_x - range, 0);
-    int maxx = std::max(source.crop_x + source.crop_w, w);
+    if constexpr (Output == SDFOutput::Alpha8)
+        return (u32)std::clamp(dist + 128, 0, 255);
 
-    for (int yy = miny; yy < maxy; yy++)
+    u32 rgb = Output == SDFOutput::PositionRGB ? (nx << 16 | ny << 8 | 0xff) : 0x00ffffff;
+    if (dist > -128 && dist < 128)
     {
-        int ysrc = yy;
-        for (int xx = minx; xx < maxx; xx++)
+        u32 nd = dist + 128;
+        return nd << 24 | rgb;
+    }
+    else if (dist <= -127)
+    {
+        return rgb;
+    }
+    return 0xff000000 | rgb;
+}
+
+// distance to the closest pixel in row y within maxDx of cx whose state is not 'on', or -1 if there isn't one
+// tests a whole mask word at a time - XOR against the centre state leaves only the transitions set
+int PixelBlockDistanceFinder::NearestInRow(int cx, int y, bool on, int maxDx) const
+{
+    const u64* row = &pixelMaskFullRez[y * fullPitch];
+    u64 flip = on ? ~(u64)0 : 0;
+    int best = -1;
+
+    // search right
+    int xs = std::max(cx, 0);
+    int xe = std::min(cx + maxDx, w - 1);
+    for (int wi = xs / 64; wi <= xe / 64 && xs <= xe; wi++)
+    {
+        u64 bits = row[wi] ^ flip;
+        if (wi == xs / 64)
+            bits &= ~(u64)0 << (xs & 63);
+        if (wi == xe / 64)
+            bits &= ~(u64)0 >> (63 - (xe & 63));
+        if (bits)
         {
-            int xsrc = xx;
-            int distX, distY;
-            int dist = sourceDF.FindDistance(xsrc, ysrc, range, distX, distY);
-            u32 nx = xx * 255 / (w - 1);
-            u32 ny = yy * 255 / (h - 1);
-            if (dist > -128 && dist < 128)
+            best = wi * 64 + std::countr_zero(bits) - cx;
+            maxDx = best - 1;
+            break;
+        }
+    }
+
+    // search left - only needs to beat the right hand result
+    xs = std::max(cx - maxDx, 0);
+    xe = std::min(cx - 1, w - 1);
+    for (int wi = xe / 64; wi >= xs / 64 && xs <= xe; wi--)
+    {
+        u64 bits = row[wi] ^ flip;
+        if (wi == xe / 64)
+            bits &= ~(u64)0 >> (63 - (xe & 63));
+        if (wi == xs / 64)
+            bits &= ~(u64)0 << (xs & 63);
+        if (bits)
+        {
+            best = cx - (wi * 64 + 63 - std::countl_zero(bits));
+            break;
+        }
+    }
+
+    return best;
+}
+
+// 64 mask bits of row y starting at x0 - bits outside the mask read as 0
+static u64 ExtractMaskBits(const u64* row, int pitch, int x0)
+{
+    int wi = x0 >> 6;
+    int shift = x0 & 63;
+    u64 lo = (wi >= 0 && wi < pitch) ? row[wi] : 0;
+    if (!shift)
+        return lo;
+    u64 hi = (wi + 1 >= 0 && wi + 1 < pitch) ? row[wi + 1] : 0;
+    return (lo >> shift) | (hi << (64 - shift));
+}
+
+// low 'count' bits set
+static u64 LowBits(int count)
+{
+    return count <= 0 ? 0 : count >= 64 ? ~(u64)0 : ((u64)1 << count) - 1;
+}
+
+// squared distance to the nearest pixel not in state 'on', searching outwards a row at a time
+// Range > 0 fixes the range at compile time - each row is then two fixed size bit windows around cx with constant masks
+// Range == 0 walks the mask words with NearestInRow for any range
+template<int Range>
+int PixelBlockDistanceFinder::SearchRows(int cx, int cy, bool on, int range, int& distX, int& distY) const
+{
+    static_assert(Range < 64, "bit window search needs the range to fit in a mask word");
+    if (Range)
+        range = Range;
+
+    u64 flip = on ? ~(u64)0 : 0;
+
+    // which bits of the right (cx..cx+range) and left (cx-range..cx-1) windows are inside the mask
+    u64 validRight = 0;
+    u64 validLeft = 0;
+    if (Range)
+    {
+        validRight = LowBits(Range + 1) & LowBits(w - cx) & ~LowBits(-cx);
+        validLeft = LowBits(Range) & LowBits(w - (cx - Range)) & ~LowBits(Range - cx);
+    }
+
+    int bestSq = EDTInfinity;
+    for (int dy = 0; dy <= range && dy * dy < bestSq; dy++)
+    {
+        for (int side = 0; side < (dy ? 2 : 1); side++)
+        {
+            int y = side ? cy - dy : cy + dy;
+            if (y < 0 || y >= h)
+                continue;
+
+            int dx = -1;
+            if (Range)
             {
-                u32 nd = dist + 128;
-                u32 out = nd << 24 | nx << 16 | ny << 8 | 0xff;
-                pixels[yy * pitch / 4 + xx] = out;
+                const u64* row = &pixelMaskFullRez[y * fullPitch];
+                u64 right = (ExtractMaskBits(row, fullPitch, cx) ^ flip) & validRight;
+                u64 left = (ExtractMaskBits(row, fullPitch, cx - Range) ^ flip) & validLeft;
+                if (right)
+                    dx = std::countr_zero(right);
+                if (left)
+                {
+                    int leftDx = Range - (63 - std::countl_zero(left));
+                    if (dx < 0 || leftDx < dx)
+                        dx = leftDx;
+                }
             }
-            else if (dist <= -127)
+            else
             {
-                pixels[yy * pitch / 4 + xx] = nx << 16 | ny << 8 | 0xff;
+                dx = NearestInRow(cx, y, on, range);
             }
-            else
+
+            if (dx >= 0 && dx * dx + dy * dy < bestSq)
+            {
+                bestSq = dx * dx + dy * dy;
+                distX = dx * 127 / range;
+                distY = (side ? -dy : dy) * 127 / range;
+            }
+        }
+    }
+    return bestSq;
+}
+
+static SDFParallelFor g_sdfParallelFor;
+
+void SetSDFParallelFor(const SDFParallelFor& parallelFor)
+{
+    SDL_assert(!g_sdfParallelFor);
+    g_sdfParallelFor = parallelFor;
+}
+
+// rows or columns per band of a split SDF - a multiple of the 8 pixel tiles
+static const int SDFBandSize = 32;
+
+// func(begin, end) over 0..count in bands of 'band', at the same time when 'parallel' and there's somewhere to run them
+// bands not started by the time the job is cancelled are skipped
+static void ForEachBand(int count, int band, bool parallel, const std::function<void(int, int)>& func)
+{
+    int bands = (count + band - 1) / band;
+    auto runBand = [&](int b)
+        {
+            if (!JobCancelled())
+                func(b * band, std::min(b * band + band, count));
+        };
+    if (parallel && bands > 1 && g_sdfParallelFor)
+    {
+        g_sdfParallelFor(bands, runBand);
+        return;
+    }
+    for (int b = 0; b < bands; b++)
+        runBand(b);
+}
+
+// signed distance of one pixel with a per pixel engine - EDT only works on whole blocks so it searches rows instead
+template<int Range>
+static int SearchDistance(const PixelBlockDistanceFinder& sourceDF, int x, int y, int range, SDFEngine engine)
+{
+    int distX, distY;
+    if (engine == SDFEngine::Spiral)
+        return sourceDF.FindDistance(x, y, range, distX, distY);
+
+    bool pixOn = sourceDF.IsOn(x, y);
+    return EncodeDistance<Range>(sourceDF.SearchRows<Range>(x, y, pixOn, range, distX, distY), pixOn, range);
+}
+
+// Range > 0 is a compile time range so the search loops unroll and the quantisation constant folds
+// Range == 0 is the generic kernel for any range
+template<int Range, SDFOutput Output>
+static void GenerateSDFKernel(PixelBlock& dest, const PixelBlock& source, const PixelBlockDistanceFinder& sourceDF, int range, SDFEngine engine,
+    const SDFKernelOptions& options)
+{
+    if (Range)
+        range = Range;
+
+    const int w = dest.w;
+    const int h = dest.h;
+
+    // only pixels within range of the glyph need a search, everything else is fully outside
+    // coverage edges can sit up to a pixel outside the crop, and faint coverage doesn't reach the mask the tile tests use
+    const bool coverage = engine == SDFEngine::Coverage;
+    const int reach = coverage ? range + 1 : range;
+    int miny = std::max(source.crop_y - reach, 0);
+    int maxy = std::min(source.crop_y + source.crop_h + reach, h);
+    int minx = std::max(source.crop_x - reach, 0);
+    int maxx = std::min(source.crop_x + source.crop_w + reach, w);
+
+    std::vector<int> distSq;
+    std::vector<float> coverageDist;
+    if (engine == SDFEngine::EDT)
+        sourceDF.FindDistancesEDT(w, h, distSq, options.parallel);
+    else if (engine == SDFEngine::Coverage)
+        sourceDF.FindDistancesCoverage(source, w, h, coverageDist, options.parallel);
+
+    // normalised x position only changes per column
+    std::vector<u32> nxs;
+    if (Output == SDFOutput::PositionRGB)
+    {
+        nxs.resize(w);
+        for (int xx = 0; xx < w; xx++)
+            nxs[xx] = xx * 255 / (w - 1);
+    }
+
+    // work in 8x8 tiles so whole tiles far from any edge can be filled without a search
+    // large blocks split into bands of tile rows that can run at the same time
+    ForEachBand(h, SDFBandSize, options.parallel && w * h >= SDFParallelMinPixels, [&](int bandBegin, int bandEnd)
+        {
+            for (int ty = bandBegin; ty < bandEnd; ty += 8)
             {
-                pixels[yy * pitch / 4 + xx] = 0xff000000 | nx << 16 | ny << 8 | 0xff;
+                int tyEnd = std::min(ty + 8, h);
+                for (int tx = 0; tx < w; tx += 8)
+                {
+                    int txEnd = std::min(tx + 8, w);
+
+                    int saturated = 0;
+                    if (ty >= maxy || tyEnd <= miny || tx >= maxx || txEnd <= minx)
+                        saturated = -128;
+                    else if (coverage)
+                        saturated = 0;
+                    else if (sourceDF.IsSaturated(tx - range, ty - range, txEnd + range, tyEnd + range, false))
+                        saturated = -128;
+                    else if (txEnd <= sourceDF.w && tyEnd <= sourceDF.h && sourceDF.IsSaturated(tx - range, ty - range, txEnd + range, tyEnd + range, true))
+                        saturated = 128;
+
+                    for (int yy = ty; yy < tyEnd; yy++)
+                    {
+                        int ysrc = yy;
+                        u32 ny = Output == SDFOutput::PositionRGB ? yy * 255 / (h - 1) : 0;
+                        u8* out8 = dest.Row(yy);
+                        u32* out32 = dest.Row32(yy);
+                        for (int xx = tx; xx < txEnd; xx++)
+                        {
+                            int xsrc = xx;
+                            u32 nx = Output == SDFOutput::PositionRGB ? nxs[xx] : 0;
+                            int dist = saturated;
+                            if (saturated == 0)
+                            {
+                                if (engine == SDFEngine::EDT)
+                                {
+                                    dist = EncodeDistance<Range>(distSq[yy * w + xx], sourceDF.IsOn(xsrc, ysrc), range);
+                                }
+                                else if (engine == SDFEngine::Coverage)
+                                {
+                                    dist = EncodeCoverageDistance(coverageDist[yy * w + xx], range);
+                                }
+                                else
+                                {
+                                    dist = SearchDistance<Range>(sourceDF, xsrc, ysrc, range, engine);
+                                }
+                            }
+                            if constexpr (Output == SDFOutput::Alpha8)
+                                out8[xx] = (u8)EncodeSDFPixel<Output>(dist, nx, ny);
+                            else
+                                out32[xx] = EncodeSDFPixel<Output>(dist, nx, ny);
+                        }
+                    }
+                }
             }
+        });
+}
+
+template<SDFOutput Output>
+static void DispatchSDFKernel(PixelBlock& dest, const PixelBlock& source, const PixelBlockDistanceFinder& sourceDF, int range, SDFEngine engine,
+    const SDFKernelOptions& options)
+{
+    if (options.specialised)
+    {
+        switch (range)
+        {
+            case 4: GenerateSDFKernel<4, Output>(dest, source, sourceDF, range, engine, options); return;
+            case 8: GenerateSDFKernel<8, Output>(dest, source, sourceDF, range, engine, options); return;
+            case 16: GenerateSDFKernel<16, Output>(dest, source, sourceDF, range, engine, options); return;
+            case 32: GenerateSDFKernel<32, Output>(dest, source, sourceDF, range, engine, options); return;
+        }
+    }
+    GenerateSDFKernel<0, Output>(dest, source, sourceDF, range, engine, options);
+}
+
+void PixelBlock::GenerateSDF(const PixelBlock& source, const PixelBlockDistanceFinder &sourceDF, int range, SDFEngine engine, SDFOutput output,
+    const SDFKernelOptions& options)
+{
+    TraceScope trace("sdf");
+    range = ClampRange(range);
+
+    if (format == PixelFormat::A8)
+        DispatchSDFKernel<SDFOutput::Alpha8>(*this, source, sourceDF, range, engine, options);
+    else if (output == SDFOutput::WhiteRGB)
+        DispatchSDFKernel<SDFOutput::WhiteRGB>(*this, source, sourceDF, range, engine, options);
+    else
+        DispatchSDFKernel<SDFOutput::PositionRGB>(*this, source, sourceDF, range, engine, options);
+}
+
+// source pixel under each of 'gridSize' evenly spaced samples - every pixel when the grid is the source size
+static void BuildSampleMap(std::vector<int>& map, int srcSize, int gridSize)
+{
+    map.resize(gridSize);
+    for (int i = 0; i < gridSize; i++)
+        map[i] = gridSize == srcSize ? i : std::min((int)((i + 0.5) * srcSize / gridSize), srcSize - 1);
+}
+
+// GenerateSDF + Scale in one pass - the full rez SDF is never stored, only the few sample rows the filter currently reads
+// distances are only searched at samples that feed an output pixel whose footprint isn't saturated
+template<int Range>
+static void GenerateScaledSDFKernel(PixelBlock& dest, const PixelBlock& source, const PixelBlockDistanceFinder& sourceDF, int range, SDFEngine engine,
+    const std::vector<int>& colSrc, const std::vector<int>& rowSrc, const ResampleAxis& xAxis, const ResampleAxis& yAxis, bool parallel)
+{
+    if (Range)
+        range = Range;
+
+    const int gridW = xAxis.srcSize;
+
+    int minx = source.crop_x - range;
+    int maxx = source.crop_x + source.crop_w + range;
+    int miny = source.crop_y - range;
+    int maxy = source.crop_y + source.crop_h + range;
+
+    // large sources split into bands of output rows covering about SDFBandSize source rows each
+    int band = std::max(1, SDFBandSize * dest.h / std::max(source.h, 1));
+    ForEachBand(dest.h, band, parallel && source.w * source.h >= SDFParallelMinPixels, [&](int bandBegin, int bandEnd)
+        {
+            // rows are requested in increasing order so a ring of maxCount rows always holds every row an output row reads
+            // each band has its own ring and tile states, at band edges a few sample rows get searched twice
+            const int ringSize = yAxis.maxCount;
+            std::vector<u8> ring(ringSize * gridW, 0);
+            std::vector<u8> ringDone(ringSize * gridW, 0);
+            std::vector<int> ringRow(ringSize, -1);
+            std::vector<const u8*> rows(ringSize);
+
+            // 8x8 source tiles far from any edge, classified on first use: 1 unknown, 0 needs a search, else the saturated distance
+            const int tilesW = (source.w + 7) / 8;
+            std::vector<int> tileState(tilesW * ((source.h + 7) / 8), 1);
+
+            std::vector<u8> need(gridW);
+            std::vector<int> saturated(dest.w);
+            std::vector<float> column(gridW);
+            std::vector<u8> filtered(dest.w);
+
+            for (int y = bandBegin; y < bandEnd; y++)
+            {
+                // a band can cover a whole small glyph's rows, so this kernel checks every output row
+                if (JobCancelled())
+                    return;
+                int g0 = yAxis.start[y];
+                int g1 = g0 + yAxis.count[y];
+                int y0 = rowSrc[g0];
+                int y1 = rowSrc[g1 - 1] + 1;
+
+                // classify each output pixel by its source footprint, same tests as the tiled kernel
+                std::fill(need.begin(), need.end(), 0);
+                bool anyNeeded = false;
+                for (int x = 0; x < dest.w; x++)
+                {
+                    int x0 = colSrc[xAxis.start[x]];
+                    int x1 = colSrc[xAxis.start[x] + xAxis.count[x] - 1] + 1;
+                    int sat = 0;
+                    if (y0 >= maxy || y1 <= miny || x0 >= maxx || x1 <= minx)
+                        sat = -128;
+                    else if (sourceDF.IsSaturated(x0 - range, y0 - range, x1 + range, y1 + range, false))
+                        sat = -128;
+                    else if (x1 <= sourceDF.w && y1 <= sourceDF.h && sourceDF.IsSaturated(x0 - range, y0 - range, x1 + range, y1 + range, true))
+                        sat = 128;
+                    saturated[x] = sat;
+                    if (sat == 0)
+                    {
+                        std::fill(need.begin() + xAxis.start[x], need.begin() + xAxis.start[x] + xAxis.count[x], 1);
+                        anyNeeded = true;
+                    }
+                }
+
+                if (anyNeeded)
+                {
+                    for (int g = g0; g < g1; g++)
+                    {
+                        int slot = g % ringSize;
+                        u8* row = &ring[slot * gridW];
+                        u8* done = &ringDone[slot * gridW];
+                        if (ringRow[slot] != g)
+                        {
+                            ringRow[slot] = g;
+                            std::fill(done, done + gridW, 0);
+                        }
+                        int sy = rowSrc[g];
+                        for (int gx = 0; gx < gridW; gx++)
+                        {
+                            if (need[gx] && !done[gx])
+                            {
+                                int sx = colSrc[gx];
+                                int& tile = tileState[(sy / 8) * tilesW + sx / 8];
+                                if (tile == 1)
+                                {
+                                    int tx = sx & ~7;
+                                    int ty = sy & ~7;
+                                    int txEnd = std::min(tx + 8, source.w);
+                                    int tyEnd = std::min(ty + 8, source.h);
+                                    tile = 0;
+                                    if (sourceDF.IsSaturated(tx - range, ty - range, txEnd + range, tyEnd + range, false))
+                                        tile = -128;
+                                    else if (txEnd <= sourceDF.w && tyEnd <= sourceDF.h && sourceDF.IsSaturated(tx - range, ty - range, txEnd + range, tyEnd + range, true))
+                                        tile = 128;
+                                }
+                                int dist = tile ? tile : SearchDistance<Range>(sourceDF, sx, sy, range, engine);
+                                row[gx] = (u8)EncodeSDFPixel<SDFOutput::Alpha8>(dist, 0, 0);
+                                done[gx] = 1;
+                            }
+                        }
+                        rows[g - g0] = row;
+                    }
+                    ResampleRow(filtered.data(), rows.data(), y, 1, xAxis, yAxis, column.data());
+                }
+
+                // saturated footprints filter to exactly fully out or fully in
+                u8* out8 = dest.Row(y);
+                u32* out32 = dest.Row32(y);
+                for (int x = 0; x < dest.w; x++)
+                {
+                    u8 alpha = saturated[x] ? (saturated[x] < 0 ? 0 : 255) : filtered[x];
+                    if (dest.format == PixelFormat::A8)
+                        out8[x] = alpha;
+                    else
+                        out32[x] = (u32)alpha << 24 | 0x00ffffff;
+                }
+            }
+        });
+}
+
+void PixelBlock::GenerateScaledSDF(const PixelBlock& source, const PixelBlockDistanceFinder& sourceDF, int range, ResampleFilter filter, int samples, SDFEngine engine,
+    const SDFKernelOptions& options)
+{
+    // the fused kernel scales as it goes, so its span covers both
+    TraceScope trace("sdf scale");
+    if (source.w == 0 || source.h == 0)
+        return;
+
+    range = ClampRange(range);
+
+    if (engine == SDFEngine::Coverage)
+    {
+        PixelBlock full;
+        full.Allocate(source.w, source.h, PixelFormat::A8);
+        full.GenerateSDF(source, sourceDF, range, engine, SDFOutput::Alpha8, options);
+        if (!JobCancelled())
+            Scale(full, filter);
+        full.Free();
+        return;
+    }
+
+    // the filter runs over a grid of samples instead of every source pixel - never finer than the source itself
+    int gridW = samples > 0 ? std::min(w * samples, source.w) : source.w;
+    int gridH = samples > 0 ? std::min(h * samples, source.h) : source.h;
+    std::vector<int> colSrc, rowSrc;
+    BuildSampleMap(colSrc, source.w, gridW);
+    BuildSampleMap(rowSrc, source.h, gridH);
+    // held until the kernel returns - its bands on other workers read the tables too
+    auto xAxis = GetResampleAxis(filter, gridW, w);
+    auto yAxis = GetResampleAxis(filter, gridH, h);
+
+    if (options.specialised)
+    {
+        switch (range)
+        {
+            case 4: GenerateScaledSDFKernel<4>(*this, source, sourceDF, range, engine, colSrc, rowSrc, *xAxis, *yAxis, options.parallel); return;
+            case 8: GenerateScaledSDFKernel<8>(*this, source, sourceDF, range, engine, colSrc, rowSrc, *xAxis, *yAxis, options.parallel); return;
+            case 16: GenerateScaledSDFKernel<16>(*this, source, sourceDF, range, engine, colSrc, rowSrc, *xAxis, *yAxis, options.parallel); return;
+            case 32: GenerateScaledSDFKernel<32>(*this, source, sourceDF, range, engine, colSrc, rowSrc, *xAxis, *yAxis, options.parallel); return;
         }
     }
+    GenerateScaledSDFKernel<0>(*this, source, sourceDF, range, engine, colSrc, rowSrc, *xAxis, *yAxis, options.parallel);
 }
 
 void PixelBlock::Dump()
@@ -235,7 +860,7 @@ void PixelBlock::Dump()
     {
         for (int x = 0; x < w; x++)
         {
-            u8 val = (pixels[y * (pitch / 4) + x] & 0xff000000) >> 24;
+            u8 val = Alpha(x, y);
             line[x] = val > 0 ? 'A'+val/30 : '.';
         }
         SDL_Log("%03d:%s",y,line);
@@ -256,13 +881,93 @@ void PixelBlockDistanceFinder::Generate(const PixelBlock& source)
     {
         for (int x = 0; x < source.w; x++)
         {
-            u8 val = source.pixels[y * source.pitch / 4 + x] >> 24;
+            u8 val = source.Alpha(x, y);
             if (val >= 0x80)
             {
                 pixelMaskFullRez[y * fullPitch + x / 64] |= (u64)1 << (x & 63);
             }
         }
     }
+
+    // 8x8 tiles - one byte of 8 mask words each
+    int tilesH8 = (h + 7) / 8;
+    tilePitch8 = (w + 7) / 8;
+    tileMask8 = new u8[tilePitch8 * tilesH8];
+    for (int ty = 0; ty < tilesH8; ty++)
+    {
+        for (int tx = 0; tx < tilePitch8; tx++)
+        {
+            int bits = std::min(w - tx * 8, 8);
+            u8 full = (u8)((1 << bits) - 1);
+            u8 flags = 0;
+            for (int y = ty * 8; y < std::min(ty * 8 + 8, h); y++)
+            {
+                u8 row = (u8)(pixelMaskFullRez[y * fullPitch + tx / 8] >> ((tx & 7) * 8)) & full;
+                if (row != 0)
+                    flags |= MaskHasOn;
+                if (row != full)
+                    flags |= MaskHasOff;
+            }
+            tileMask8[ty * tilePitch8 + tx] = flags;
+        }
+    }
+
+    // 64x64 tiles - combination of the 8x8 tiles
+    int tilesH64 = (h + 63) / 64;
+    tilePitch64 = (w + 63) / 64;
+    tileMask64 = new u8[tilePitch64 * tilesH64];
+    memset(tileMask64, 0, tilePitch64 * tilesH64);
+    for (int ty = 0; ty < tilesH8; ty++)
+    {
+        for (int tx = 0; tx < tilePitch8; tx++)
+        {
+            tileMask64[(ty / 8) * tilePitch64 + tx / 8] |= tileMask8[ty * tilePitch8 + tx];
+        }
+    }
+}
+
+// combined MaskTileFlags of every mask pixel in x1..x2, y1..y2 (exclusive) - conservative, partially covered tiles count in full
+u8 PixelBlockDistanceFinder::RegionFlags(int x1, int y1, int x2, int y2) const
+{
+    x1 = std::max(x1, 0);
+    y1 = std::max(y1, 0);
+    x2 = std::min(x2, w);
+    y2 = std::min(y2, h);
+    if (x1 >= x2 || y1 >= y2)
+        return 0;
+
+    u8 flags = 0;
+    for (int ty = y1 / 64; ty <= (y2 - 1) / 64; ty++)
+    {
+        for (int tx = x1 / 64; tx <= (x2 - 1) / 64; tx++)
+        {
+            u8 tile = tileMask64[ty * tilePitch64 + tx];
+            if (tile != MaskMixed)
+            {
+                flags |= tile;
+            }
+            else
+            {
+                // mixed at low rez, check the 8x8 tiles that are actually inside the region
+                int sx = std::max(x1, tx * 64) / 8;
+                int ex = (std::min(x2, tx * 64 + 64) - 1) / 8;
+                int sy = std::max(y1, ty * 64) / 8;
+                int ey = (std::min(y2, ty * 64 + 64) - 1) / 8;
+                for (int y = sy; y <= ey; y++)
+                    for (int x = sx; x <= ex; x++)
+                        flags |= tileMask8[y * tilePitch8 + x];
+            }
+            if (flags == MaskMixed)
+                return flags;
+        }
+    }
+    return flags;
+}
+
+// true if no pixel in the region is in the opposite state to 'on'
+bool PixelBlockDistanceFinder::IsSaturated(int x1, int y1, int x2, int y2, bool on) const
+{
+    return (RegionFlags(x1, y1, x2, y2) & (on ? MaskHasOff : MaskHasOn)) == 0;
 }
 
 int PixelBlockDistanceFinder::FindDistance(int cx, int cy, int range, int &distX, int &distY) const
@@ -275,11 +980,16 @@ int PixelBlockDistanceFinder::FindDistance(int cx, int cy, int range, int &distX
         pixOn = pixelMaskFullRez[cy * fullPitch + x] & ((u64)1 << bit) ? true : false;
     }
 
+    // nothing of the opposite state anywhere in range
+    range = ClampRange(range);
+    if (IsSaturated(cx - range, cy - range, cx + range + 1, cy + range + 1, pixOn))
+        return pixOn ? 128 : -128;
+
     float fcx = (float)cx;
     float fcy = (float)cy;
 
     // find closest pixel OFF
-    for (auto &check : g_posChecks)
+    for (auto &check : GetPosChecks(range))
     {
         int xo = cx + check.xo;
         int yo = cy + check.yo;
@@ -291,15 +1001,26 @@ int PixelBlockDistanceFinder::FindDistance(int cx, int cy, int range, int &distX
         bool localOn = pixelMaskFullRez[yo * fullPitch + x] & ((u64)1 << bit) ? true : false;
         if (pixOn != localOn)
         {
-            distX = check.xo * 127 / 32;
-            distY = check.yo * 127 / 32;
-            return pixOn ? (int)(check.dist - 1.0f / 32.0f * 127.0f) : (int)-check.dist;
+            distX = check.xo * 127 / range;
+            distY = check.yo * 127 / range;
+            return pixOn ? (int)(check.dist - 1.0f / (float)range * 127.0f) : (int)-check.dist;
         }
     }
 
     return pixOn ? 128 : -128;
 }
 
+// same result as FindDistance, but searching outwards a row at a time instead of a pixel at a time
+int PixelBlockDistanceFinder::FindDistanceRows(int cx, int cy, int range, int& distX, int& distY) const
+{
+    bool pixOn = IsOn(cx, cy);
+    range = ClampRange(range);
+    if (IsSaturated(cx - range, cy - range, cx + range + 1, cy + range + 1, pixOn))
+        return pixOn ? 128 : -128;
+
+    return EncodeDistance(SearchRows<0>(cx, cy, pixOn, range, distX, distY), pixOn, range);
+}
+
 void PixelBlockDistanceFinder::Dump() const
 {
     char* line = new char[w+1];
@@ -315,4 +1036,257 @@ void PixelBlockDistanceFinder::Dump() const
     }
 }
 
+// 1D squared distance transform (Felzenszwalb & Huttenlocher) - lower envelope of parabolas rooted at each finite f[q]
+// v and z are scratch space of n and n+1 entries, nearest optionally gets the index of the parabola each d came from
+static void EDT1D(const int* f, int* d, int n, int* v, double* z, int* nearest = nullptr)
+{
+    int k = -1;
+    for (int q = 0; q < n; q++)
+    {
+        if (f[q] >= EDTInfinity)
+            continue;
+
+        double s = 0.0;
+        while (k >= 0)
+        {
+            int p = v[k];
+            s = ((double)(f[q] + q * q) - (double)(f[p] + p * p)) / (2.0 * (q - p));
+            if (s > z[k])
+                break;
+            k--;
+        }
+        k++;
+        v[k] = q;
+        z[k] = k == 0 ? -1e30 : s;
+        z[k + 1] = 1e30;
+    }
+
+    if (k < 0)
+    {
+        for (int q = 0; q < n; q++)
+        {
+            d[q] = EDTInfinity;
+            if (nearest)
+                nearest[q] = -1;
+        }
+        return;
+    }
+
+    int j = 0;
+    for (int q = 0; q < n; q++)
+    {
+        while (z[j + 1] < q)
+            j++;
+        int dx = q - v[j];
+        d[q] = std::min(dx * dx + f[v[j]], EDTInfinity);
+        if (nearest)
+            nearest[q] = v[j];
+    }
+}
+
+// exact squared distance from each pixel of an outW x outH block to the nearest mask pixel in state 'on'
+// only pixels inside the mask are candidates, same as the spiral search which skips out of bounds offsets
+static void EDT2D(const PixelBlockDistanceFinder& df, bool on, int outW, int outH, std::vector<int>& out, bool parallel)
+{
+    out.resize(outW * outH);
+    parallel = parallel && outW * outH >= SDFParallelMinPixels;
+
+    // columns - distance to the nearest feature in the same column
+    ForEachBand(outW, SDFBandSize, parallel, [&](int x0, int x1)
+        {
+            for (int x = x0; x < x1; x++)
+            {
+                int gap = EDTInfinity;
+                for (int y = 0; y < outH; y++)
+                {
+                    bool feature = x < df.w && y < df.h && df.IsOn(x, y) == on;
+                    gap = feature ? 0 : std::min(gap + 1, EDTInfinity);
+                    out[y * outW + x] = gap;
+                }
+                gap = EDTInfinity;
+                for (int y = outH - 1; y >= 0; y--)
+                {
+                    int& g = out[y * outW + x];
+                    gap = g == 0 ? 0 : std::min(gap + 1, EDTInfinity);
+                    g = std::min(g, gap);
+                }
+                for (int y = 0; y < outH; y++)
+                {
+                    int& g = out[y * outW + x];
+                    g = g >= 46340 ? EDTInfinity : g * g;
+                }
+            }
+        });
+
+    // rows - combine the column distances into the true 2D distance
+    ForEachBand(outH, SDFBandSize, parallel, [&](int y0, int y1)
+        {
+            std::vector<int> f(outW);
+            std::vector<int> v(outW);
+            std::vector<double> z(outW + 1);
+            for (int y = y0; y < y1; y++)
+            {
+                int* row = &out[y * outW];
+                std::copy(row, row + outW, f.begin());
+                EDT1D(f.data(), row, outW, v.data(), z.data());
+            }
+        });
+}
+
+void PixelBlockDistanceFinder::FindDistancesEDT(int outW, int outH, std::vector<int>& distSq, bool parallel) const
+{
+    // inside pixels want the nearest OFF pixel, outside pixels the nearest ON pixel
+    std::vector<int> toOff;
+    EDT2D(*this, true, outW, outH, distSq, parallel);
+    EDT2D(*this, false, outW, outH, toOff, parallel);
 
+    for (int y = 0; y < outH; y++)
+    {
+        for (int x = 0; x < outW; x++)
+        {
+            if (IsOn(x, y))
+                distSq[y * outW + x] = toOff[y * outW + x];
+        }
+    }
+}
+
+// distance from a pixel centre to a straight edge crossing it, from the pixel coverage a (0..1) and the coverage gradient
+// positive when the centre is outside - Gustavson & Strand's anti-aliased EDT edge model
+static float EdgeOffset(float gx, float gy, float a)
+{
+    if (gx == 0.0f || gy == 0.0f)
+        return 0.5f - a;
+
+    gx = fabsf(gx);
+    gy = fabsf(gy);
+    if (gx < gy)
+        std::swap(gx, gy);
+
+    // the edge only clips a corner below a1 and above 1 - a1, in between it cuts straight across
+    float a1 = 0.5f * gy / gx;
+    if (a < a1)
+        return 0.5f * (gx + gy) - sqrtf(2.0f * gx * gy * a);
+    if (a < 1.0f - a1)
+        return (0.5f - a) * gx;
+    return -0.5f * (gx + gy) + sqrtf(2.0f * gx * gy * (1.0f - a));
+}
+
+// signed distance in source pixels from each pixel of an outW x outH block to the glyph edge, positive inside
+// the EDT finds the nearest edge pixel - partially covered or touching the other side of the mask - and the edge point
+// inside that pixel comes from its coverage, so the result isn't quantised to whole source pixels
+void PixelBlockDistanceFinder::FindDistancesCoverage(const PixelBlock& source, int outW, int outH, std::vector<float>& dist, bool parallel) const
+{
+    parallel = parallel && outW * outH >= SDFParallelMinPixels;
+    auto alpha = [&](int x, int y)
+        {
+            x = std::clamp(x, 0, source.w - 1);
+            y = std::clamp(y, 0, source.h - 1);
+            return source.Alpha(x, y) * (1.0f / 255.0f);
+        };
+
+    // edge point of every edge pixel
+    std::vector<float> edgeX(outW * outH);
+    std::vector<float> edgeY(outW * outH);
+    std::vector<u8> isEdge(outW * outH, 0);
+    ForEachBand(std::min(outH, h), SDFBandSize, parallel, [&](int y0, int y1)
+        {
+            for (int y = y0; y < y1; y++)
+            {
+                for (int x = 0; x < std::min(outW, w); x++)
+                {
+                    u8 a8 = source.Alpha(x, y);
+                    bool on = a8 >= 0x80;
+                    if ((a8 == 0 || a8 == 255) && IsOn(x - 1, y) == on && IsOn(x + 1, y) == on && IsOn(x, y - 1) == on && IsOn(x, y + 1) == on)
+                        continue;
+
+                    // sobel gradient of the coverage, pointing inside
+                    const float k = 1.41421356f;
+                    float gx = alpha(x + 1, y - 1) + k * alpha(x + 1, y) + alpha(x + 1, y + 1) - alpha(x - 1, y - 1) - k * alpha(x - 1, y) - alpha(x - 1, y + 1);
+                    float gy = alpha(x - 1, y + 1) + k * alpha(x, y + 1) + alpha(x + 1, y + 1) - alpha(x - 1, y - 1) - k * alpha(x, y - 1) - alpha(x + 1, y - 1);
+                    float len = sqrtf(gx * gx + gy * gy);
+                    if (len > 0.0f)
+                    {
+                        gx /= len;
+                        gy /= len;
+                    }
+
+                    float offset = EdgeOffset(gx, gy, a8 * (1.0f / 255.0f));
+                    edgeX[y * outW + x] = x + gx * offset;
+                    edgeY[y * outW + x] = y + gy * offset;
+                    isEdge[y * outW + x] = 1;
+                }
+            }
+        });
+
+    // columns - nearest edge row in the same column
+    std::vector<int> distSq(outW * outH);
+    std::vector<int> siteY(outW * outH);
+    ForEachBand(outW, SDFBandSize, parallel, [&](int x0, int x1)
+        {
+            for (int x = x0; x < x1; x++)
+            {
+                int last = -1;
+                for (int y = 0; y < outH; y++)
+                {
+                    if (isEdge[y * outW + x])
+                        last = y;
+                    siteY[y * outW + x] = last;
+                }
+                last = -1;
+                for (int y = outH - 1; y >= 0; y--)
+                {
+                    if (isEdge[y * outW + x])
+                        last = y;
+                    int& s = siteY[y * outW + x];
+                    if (last >= 0 && (s < 0 || last - y < y - s))
+                        s = last;
+                    int dy = s < 0 ? 46340 : y - s;
+                    distSq[y * outW + x] = dy >= 46340 ? EDTInfinity : dy * dy;
+                }
+            }
+        });
+
+    // rows - the column that wins gives the 2D nearest edge pixel
+    std::vector<int> siteX(outW * outH);
+    ForEachBand(outH, SDFBandSize, parallel, [&](int y0, int y1)
+        {
+            std::vector<int> f(outW);
+            std::vector<int> d(outW);
+            std::vector<int> v(outW);
+            std::vector<double> z(outW + 1);
+            for (int y = y0; y < y1; y++)
+            {
+                std::copy(&distSq[y * outW], &distSq[y * outW] + outW, f.begin());
+                EDT1D(f.data(), d.data(), outW, v.data(), z.data(), &siteX[y * outW]);
+            }
+        });
+
+    // the nearest edge pixel isn't always the one with the nearest edge point, so the neighbours' edge pixels get a look too
+    dist.resize(outW * outH);
+    ForEachBand(outH, SDFBandSize, parallel, [&](int y0, int y1)
+        {
+            for (int y = y0; y < y1; y++)
+            {
+                for (int x = 0; x < outW; x++)
+                {
+                    float best = 1e30f;
+                    const int nx[5] = { x, x - 1, x + 1, x, x };
+                    const int ny[5] = { y, y, y, y - 1, y + 1 };
+                    for (int i = 0; i < 5; i++)
+                    {
+                        if (nx[i] < 0 || nx[i] >= outW || ny[i] < 0 || ny[i] >= outH)
+                            continue;
+                        int sx = siteX[ny[i] * outW + nx[i]];
+                        int sy = sx < 0 ? -1 : siteY[ny[i] * outW + sx];
+                        if (sy < 0)
+                            continue;
+                        float ex = edgeX[sy * outW + sx] - x;
+                        float ey = edgeY[sy * outW + sx] - y;
+                        best = std::min(best, ex * ex + ey * ey);
+                    }
+                    float edgeDist = sqrtf(best);
+                    dist[y * outW + x] = IsOn(x, y) ? edgeDist : -edgeDist;
+                }
+            }
+        });
+}
@@ -1,45 +1,140 @@
 #pragma once
 
 #include "types.h"
+#include "Resampler.h"
+#include <vector>
+
+// SDF range in source pixels - distances beyond this saturate
+#define SDFDefaultRange 32
+#define SDFMaxRange 64
+// SDF range in output pixels a project starts with
+#define SDFDefaultOutputRange 4
 
 void InitPosCheckArray();
 
+// distance search used by PixelBlock::GenerateSDF - the first three produce identical output
+enum class SDFEngine
+{
+    Spiral,     // per pixel walk of the sorted offsets for the range
+    RowScan,    // per pixel nearest transition in each mask row, 64 pixels at a time
+    EDT,        // separable exact euclidean distance transform of the whole block at once
+    Coverage    // EDT to the nearest edge pixel plus the sub pixel edge position from its coverage - needs an anti-aliased source
+};
+
+// occupancy flags of a low rez mask tile
+enum MaskTileFlags : u8
+{
+    MaskHasOff = 1,
+    MaskHasOn = 2,
+    MaskMixed = MaskHasOff | MaskHasOn
+};
+
+// what PixelBlock::GenerateSDF writes to the RGB channels - alpha is always the distance
+enum class SDFOutput
+{
+    PositionRGB,    // normalised x,y position in R,G for debugging
+    WhiteRGB,       // plain white, ready for the atlas
+    Alpha8          // A8 destination, distance only - picked automatically for A8 blocks
+};
+
+// per call kernel choices - the defaults are what a bake wants, the benchmarks turn them off to compare
+struct SDFKernelOptions
+{
+    bool specialised = true;    // range specialised kernels, false forces the generic one
+    bool parallel = true;       // large SDFs split into bands through SDFParallelFor, false keeps them on the calling thread
+};
+
+// SDFs over this many pixels are split into bands of rows (or columns) that can run at the same time
+#define SDFParallelMinPixels (256 * 256)
+
+// runs func(0..count-1), possibly at the same time, and returns once every call is done - has to be safe to call from a worker
+typedef std::function<void(int count, const std::function<void(int)>& func)> SDFParallelFor;
+
+// how large SDFs run their bands - unset runs them one after another on the calling thread
+// set once at startup before any SDF runs, it's read without a lock
+void SetSDFParallelFor(const SDFParallelFor& parallelFor);
+
 struct PixelBlock;
 struct PixelBlockDistanceFinder
 {
     ~PixelBlockDistanceFinder()
     {
         delete[] pixelMaskFullRez;
+        delete[] tileMask8;
+        delete[] tileMask64;
     }
 
-    // high rez and low rez pixel mask - 1 bit per pixel on/off
+    // high rez pixel mask - 1 bit per pixel on/off
     u64* pixelMaskFullRez = nullptr;
 
+    // low rez masks - MaskTileFlags per 8x8 and 64x64 pixel tile
+    u8* tileMask8 = nullptr;
+    u8* tileMask64 = nullptr;
+
     int w = 0;
     int h = 0;
     int fullPitch = 0;
+    int tilePitch8 = 0;
+    int tilePitch64 = 0;
+
+    bool IsOn(int x, int y) const
+    {
+        if (x < 0 || x >= w || y < 0 || y >= h)
+            return false;
+        return pixelMaskFullRez[y * fullPitch + x / 64] & ((u64)1 << (x & 63)) ? true : false;
+    }
 
     void Generate(const PixelBlock& source);
+    u8 RegionFlags(int x1, int y1, int x2, int y2) const;
+    bool IsSaturated(int x1, int y1, int x2, int y2, bool on) const;
     int FindDistance(int cx, int cy, int range, int& distX, int& distY) const;
+    int FindDistanceRows(int cx, int cy, int range, int& distX, int& distY) const;
+    int NearestInRow(int cx, int y, bool on, int maxDx) const;
+    template<int Range> int SearchRows(int cx, int cy, bool on, int range, int& distX, int& distY) const;
+    // parallel lets large blocks split into bands, as in SDFKernelOptions
+    void FindDistancesEDT(int outW, int outH, std::vector<int>& distSq, bool parallel = true) const;
+    void FindDistancesCoverage(const PixelBlock& source, int outW, int outH, std::vector<float>& dist, bool parallel = true) const;
     void Dump() const;
 };
 
+enum class PixelFormat : u8
+{
+    ARGB8888,   // 4 bytes per pixel, alpha in the top byte
+    A8          // 1 byte per pixel, alpha only
+};
+
 struct PixelBlock
 {
-    u32* pixels = nullptr;
+    u8* pixels = nullptr;
+    PixelFormat format = PixelFormat::ARGB8888;
     int w = 0;
     int h = 0;
-    int pitch = 0;
+    int pitch = 0;      // in bytes
     int crop_x = 0;
     int crop_y = 0;
     int crop_w = 0;
     int crop_h = 0;
 
+    int BytesPerPixel() const { return format == PixelFormat::A8 ? 1 : 4; }
+    u8* Row(int y) const { return pixels + y * pitch; }
+    u32* Row32(int y) const { return (u32*)(pixels + y * pitch); }
+    u8 Alpha(int x, int y) const { return format == PixelFormat::A8 ? Row(y)[x] : (u8)(Row32(y)[x] >> 24); }
+
+    void Allocate(int width, int height, PixelFormat pixelFormat);
+    void Free();
+
     void CalcCropRect();
-    void GenerateSDF(const PixelBlock& source, const PixelBlockDistanceFinder& sourceDF, int range);
+    void GenerateSDF(const PixelBlock& source, const PixelBlockDistanceFinder& sourceDF, int range, SDFEngine engine = SDFEngine::EDT, SDFOutput output = SDFOutput::PositionRGB,
+        const SDFKernelOptions& options = {});
+    // GenerateSDF into a source sized block then Scale into this one, without the full rez intermediate
+    // samples > 0 only searches that many distances per output pixel along each axis, 0 searches every source pixel and matches exactly
+    // A8 blocks get the distance, ARGB blocks get white RGB - EDT falls back to RowScan as it needs the whole block
+    // Coverage needs the whole block too, so it generates the full rez SDF and scales it
+    void GenerateScaledSDF(const PixelBlock& source, const PixelBlockDistanceFinder& sourceDF, int range, ResampleFilter filter = ResampleFilter::Box,
+        int samples = 0, SDFEngine engine = SDFEngine::RowScan, const SDFKernelOptions& options = {});
     void CopyCropped(const PixelBlock& source, int x, int y);
-    void ScaleCropped(const PixelBlock& source);
-    void Scale(const PixelBlock& source);
+    void ScaleCropped(const PixelBlock& source, ResampleFilter filter = ResampleFilter::Box);
+    void Scale(const PixelBlock& source, ResampleFilter filter = ResampleFilter::Box);
     void Dump();
 };
 
@@ -10,7 +10,12 @@
 #include "imgui_impl_sdlrenderer3.h"
 #include <stdio.h>
 #include <set>
+#include <algorithm>
 #include "FontChar.h"
+#include "FontPool.h"
+#include "GlyphRaster.h"
+#include "WorkerFarm.h"
+#include "Trace.h"
 #include "SDL3/SDL_ttf.h"
 
 #define STB_IMAGE_WRITE_IMPLEMENTATION
@@ -45,6 +50,18 @@ void Project::LoadFromShad(const Shad& shad)
                 m_pageHeight = c->GetI32();
             else if (c->field == "padding")
                 m_padding = c->GetI32();
+            else if (c->field == "sdfRange")
+                m_sdfRange = std::clamp(c->GetI32(), 1, SDFMaxRange);
+            else if (c->field == "msdf")
+                m_msdf = c->GetBool();
+            else if (c->field == "glyphEngine")
+                m_glyphEngine = (GlyphEngine)std::clamp(c->GetI32(), 0, (int)GlyphEngine::Count - 1);
+            else if (c->field == "supersample")
+                m_supersample = std::clamp(c->GetI32(), 1, 16);
+            else if (c->field == "resampleFilter")
+                m_resampleFilter = (ResampleFilter)std::clamp(c->GetI32(), 0, (int)ResampleFilter::Lanczos3);
+            else if (c->field == "streamBake")
+                m_streamBake = c->GetBool();
             else if (c->field == "chars")
             {
                 for (auto ch : c->children)
@@ -65,11 +82,13 @@ void Project::LoadFromShad(const Shad& shad)
 
 Project::~Project()
 {
+    // the tasks still point at our glyphs and atlas
+    CancelJobs();
+
     if (m_ttf_font_small)
-    {
         TTF_CloseFont(m_ttf_font_small);
-        TTF_CloseFont(m_ttf_font_large);
-    }
+    delete m_fontPool;
+    delete m_glyphRaster;
     for (auto& ch : m_chars)
     {
         if (ch.preview_texture)
@@ -84,11 +103,7 @@ bool Project::Gui(SDL_Renderer* renderer)
         m_atlas.CreatePageTextures();
         for (auto& ch : m_chars)
         {
-            if (ch.pb_scaledSDF.pixels)
-            {
-                delete ch.pb_scaledSDF.pixels;
-                ch.pb_scaledSDF.pixels = nullptr;
-            }
+            ch.pb_scaledSDF.Free();
         }
 
         m_generatingSDF = false;
@@ -96,6 +111,7 @@ bool Project::Gui(SDL_Renderer* renderer)
     }
 
     m_atlas.SetRenderer(renderer);
+    m_atlas.RefreshPageTextures();
     ImGuiWindowFlags flags = ImGuiWindowFlags_HorizontalScrollbar | ImGuiWindowFlags_AlwaysVerticalScrollbar | ImGuiWindowFlags_AlwaysVerticalScrollbar;
     ImFont* font = ImGui::GetFont();
     ImGuiIO& io = ImGui::GetIO();
@@ -150,7 +166,11 @@ bool Project::Gui(SDL_Renderer* renderer)
         ImGui::SameLine(0, 100);
         if (m_generatingSDF)
         {
-            ImGui::Text("Generating Tasks %d", GetAsyncTasksRemaining());
+            ImGui::Text("Generating Glyphs %d", m_sdfJob->ItemsRemaining() + m_glyphsUnqueued);
+        }
+        else if (IsRefining())
+        {
+            ImGui::Text("Refining Glyphs %d", m_refineJob->ItemsRemaining());
         }
         else
         {
@@ -175,8 +195,46 @@ bool Project::Gui(SDL_Renderer* renderer)
         if (ImGui::Checkbox("SDF", &m_applySDF))
         {
         }
+        ImGui::SameLine(0, 100);
+        if (ImGui::Checkbox("MSDF", &m_msdf))
+        {
+        }
+        if (m_applySDF && !m_msdf)
+        {
+            ImGui::SameLine(0, 100);
+            ImGui::Combo("Engine", (int*)&m_glyphEngine, "SDL_ttf SDF\0Supersampled SDF\0Coverage SDF\0Outline SDF\0");
+            if (UseSupersample())
+            {
+                ImGui::SameLine(0, 100);
+                ImGui::SliderInt("Supersample", &m_supersample, 1, 16);
+                ImGui::SameLine(0, 100);
+                ImGui::Combo("Filter", (int*)&m_resampleFilter, "Box\0Mitchell\0Lanczos3\0");
+            }
+        }
+        if (UseSDFRange())
+        {
+            ImGui::SameLine(0, 100);
+            if (ImGui::SliderInt("SDF Range", &m_sdfRange, 1, SDFMaxRange, "%d px"))
+            {
+            }
+            // what the bake ends up using when it differs - MSDF needs 2 pixels, a wide range lowers the supersample
+            int range = SDFOutputRange();
+            int supersample = GlyphRaster::ClampSupersample(range, m_supersample);
+            if (range != m_sdfRange || (UseSupersample() && supersample != m_supersample))
+            {
+                ImGui::SameLine();
+                if (UseSupersample())
+                    ImGui::Text("using %d px at x%d", range, supersample);
+                else
+                    ImGui::Text("using %d px", range);
+            }
+        }
+        ImGui::SameLine(0, 100);
+        if (ImGui::Checkbox("Stream", &m_streamBake))
+        {
+        }
 
-        if (m_atlas.Pages().size() > 0)
+        if (m_atlas.Pages().size() > 0 && !IsRefining())
         {
             ImGui::SameLine(0, 100);
             if (ImGui::Button("Export"))
@@ -492,7 +550,7 @@ void Project::Export()
             root->AddChild("pageHeight", std::format("{}", m_pageHeight));
             root->AddChild("fontSize", std::format("{}", m_fontSize));
             root->AddChild("lineHeight", std::format("{}", m_fontSize + m_linePadding));
-            root->AddChild("cropSDF", std::format("{}", m_applySDF ? 6 : 0));
+            root->AddChild("cropSDF", std::format("{}", UseSDFRange() ? SDFOutputRange() : m_applySDF ? 6 : 0));
             auto charsNode = root->AddChild("chars", std::format("{}", m_chars.size()));
             for (auto &item : m_chars)
             {
@@ -518,21 +576,45 @@ void Project::Export()
         for (int p=0; p<m_atlas.Pages().size(); p++)
         {
             auto& page = m_atlas.Pages()[p];
-            u32* data = new u32[page.m_surface->w * page.m_surface->h];
-            u32* src = (u32*)page.m_surface->pixels;
-            u32* out = data;
-            for (int y = 0; y < page.m_surface->h; y++)
+            std::vector<uint8_t> png_buffer;
+            TraceScope trace("encode");
+            if (m_atlas.Format() == PixelFormat::A8)
             {
-                for (int x = 0; x < page.m_surface->w; x++)
+                // grey+alpha with white grey loads exactly like the old white RGBA pages but is half the size
+                std::vector<u8> data(page.m_surface->w * page.m_surface->h * 2);
+                u8* out = data.data();
+                for (int y = 0; y < page.m_surface->h; y++)
                 {
-                    u32 value = src[x];
-                    *out++ = value;
+                    const u8* src = (const u8*)page.m_surface->pixels + y * page.m_surface->pitch;
+                    for (int x = 0; x < page.m_surface->w; x++)
+                    {
+                        *out++ = 0xff;
+                        *out++ = src[x];
+                    }
                 }
-                src += page.m_surface->pitch/4;
+                stbi_write_png_to_func(write_to_memory, &png_buffer, page.m_surface->w, page.m_surface->h, 2, data.data(), page.m_surface->w * 2);
+            }
+            else
+            {
+                // ARGB words to RGBA bytes - MSDF pages need the channels where the shader expects them
+                u8* data = new u8[page.m_surface->w * page.m_surface->h * 4];
+                u32* src = (u32*)page.m_surface->pixels;
+                u8* out = data;
+                for (int y = 0; y < page.m_surface->h; y++)
+                {
+                    for (int x = 0; x < page.m_surface->w; x++)
+                    {
+                        u32 value = src[x];
+                        *out++ = (u8)(value >> 16);
+                        *out++ = (u8)(value >> 8);
+                        *out++ = (u8)value;
+                        *out++ = (u8)(value >> 24);
+                    }
+                    src += page.m_surface->pitch/4;
+                }
+                stbi_write_png_to_func(write_to_memory, &png_buffer, page.m_surface->w, page.m_surface->h, 4, data, page.m_surface->w*4);
+                delete[] data;
             }
-
-            std::vector<uint8_t> png_buffer;
-            stbi_write_png_to_func(write_to_memory, &png_buffer, page.m_surface->w, page.m_surface->h, 4, data, page.m_surface->w*4);
 
             std::filesystem::path export_filepath = filename;
             std::string export_path = (export_filepath.parent_path() / export_filepath.stem()).string() + std::format("_page{}.png", p);
@@ -550,7 +632,11 @@ void Project::Export()
             {
                 material_file << "renderpass: ui, _systemui\n";
 
-                if (m_applySDF)
+                if (UseMSDF())
+                {
+                    material_file << "\tshader : msdf_ortho\n";
+                }
+                else if (m_applySDF)
                 {
                     material_file << "\tshader : sdf_ortho\n";
                 }
@@ -597,6 +683,12 @@ void Project::Save()
         root->AddChild("pagewidth", std::format("{}", m_pageWidth));
         root->AddChild("pageheight", std::format("{}", m_pageHeight));
         root->AddChild("padding", std::format("{}", m_padding));
+        root->AddChild("sdfRange", std::format("{}", m_sdfRange));
+        root->AddChild("msdf", std::format("{}", m_msdf));
+        root->AddChild("glyphEngine", std::format("{}", (int)m_glyphEngine));
+        root->AddChild("supersample", std::format("{}", m_supersample));
+        root->AddChild("resampleFilter", std::format("{}", (int)m_resampleFilter));
+        root->AddChild("streamBake", std::format("{}", m_streamBake));
         root->AddChild("zoom", std::format("{}", m_sdf_zoom));
 
         auto charsNode = root->AddChild("chars");
@@ -630,7 +722,7 @@ void Project::GenerateFont(SDL_Renderer* renderer)
     if (m_ttf_name.empty())
         return;
 
-    AbortAsyncTasks();
+    CancelJobs();
 
     std::set<int> selected;
     for (auto &item : m_chars)
@@ -640,15 +732,12 @@ void Project::GenerateFont(SDL_Renderer* renderer)
     }
 
     TTF_Font* font_small = TTF_OpenFont(m_ttf_name.c_str(), 32);
-    TTF_Font* font_large = TTF_OpenFont(m_ttf_name.c_str(), 512);
-    if (font_small && font_large)
+    if (font_small)
     {
         if (m_ttf_font_small)
         {
             TTF_CloseFont(m_ttf_font_small);
-            TTF_CloseFont(m_ttf_font_large);
             m_ttf_font_small = nullptr;
-            m_ttf_font_large = nullptr;
 
             for (auto item : m_chars)
             {
@@ -670,7 +759,6 @@ void Project::GenerateFont(SDL_Renderer* renderer)
         }
 
         m_ttf_font_small = font_small;
-        m_ttf_font_large = font_large;
     }
 }
 
@@ -691,54 +779,131 @@ void Project::GenerateCharItem(FontChar &item, SDL_Renderer* renderer)
     }
 }
 
-void Project::GenerateCharSDF(FontChar& item)
+// the SDF work for one glyph with this bake's settings captured, so the UI can change them while it runs
+std::function<void(FontChar&)> Project::CharSDFTask(bool preview)
 {
-        auto func = [&item, fontSize = m_fontSize, &atlas = m_atlas, &font = m_ttf_font_large, &ttf_access = m_ttf_access]()
+        // supersample stays 0 unless one of our own raster SDF engines is selected
+        int supersample = 0;
+        SDFEngine engine = SDFEngine::RowScan;
+        ResampleFilter filter = ResampleFilter::Box;
+        if (UseSupersample())
+        {
+            supersample = preview ? 1 : m_supersample;
+            filter = preview ? ResampleFilter::Box : m_resampleFilter;
+            engine = m_glyphEngine == GlyphEngine::Coverage && !preview ? SDFEngine::Coverage : SDFEngine::RowScan;
+        }
+
+        return [fontSize = m_fontSize, &atlas = m_atlas, fontPool = m_fontPool, glyphRaster = m_glyphRaster, msdf = UseMSDF(),
+            outline = UseGlyphEngine() && !UseSupersample(), range = SDFOutputRange(), padding = UseSDFRange() ? SDFOutputRange() : 0, supersample, engine, filter, preview](FontChar& item)
             {
-                // generate 512 surface
-                SDL_Color white = { 255, 255, 255, 255 };
-                int minx, maxx, miny, maxy, advance;
-                ttf_access.lock();
-                auto surface = TTF_RenderGlyph_Blended(font, item.ch, white);
-                if (surface)
-                {
-                    SDL_LockSurface(surface);
-                    TTF_GetGlyphMetrics(font, item.ch, &minx, &maxx, &miny, &maxy, &advance);
-                }
-                ttf_access.unlock();
-                if (surface)
-                {
-                    // free up any old pixels
-                    delete[] item.pb_scaledSDF.pixels;
-
-                    // copy the rendered glyph into a pixel block
-                    item.pb_scaledSDF.w = surface->w;
-                    item.pb_scaledSDF.h = surface->h;
-                    item.pb_scaledSDF.pitch = surface->w * 4;
-                    item.pb_scaledSDF.pixels = new u32[item.pb_scaledSDF.w * item.pb_scaledSDF.h];
-                    for (int y = 0; y < surface->h; y++)
+                TraceScope trace("glyph");
+                int advance = 0;
+                if (glyphRaster && msdf && preview)
+                {
+                    // plain SDF in every channel for now, the refine pass replaces it with the real thing
+                    glyphRaster->RenderPreviewMSDF(item.ch, (float)fontSize, range, item.pb_scaledSDF, advance);
+                }
+                else if (glyphRaster && msdf)
+                {
+                    // multi channel SDF straight from the outline
+                    glyphRaster->RenderMSDF(item.ch, (float)fontSize, range, item.pb_scaledSDF, advance);
+                }
+                else if (glyphRaster && outline)
+                {
+                    // exact distance from the outline, already final so there's nothing to refine
+                    glyphRaster->RenderSDF(item.ch, (float)fontSize, range, item.pb_scaledSDF, advance);
+                }
+                else if (glyphRaster && supersample > 0)
+                {
+                    // our own SDF from a larger raster
+                    glyphRaster->RenderSupersampledSDF(item.ch, (float)fontSize, range, supersample, engine, filter, item.pb_scaledSDF, advance);
+                }
+                else if (glyphRaster)
+                {
+                    // coverage straight into the A8 block
+                    glyphRaster->Render(item.ch, (float)fontSize, item.pb_scaledSDF, advance);
+                }
+                else
+                {
+                    // SDL_ttf SDF render - each worker renders with its own font so there's no lock
+                    TraceScope traceRaster("raster");
+                    SDL_Color white = { 255, 255, 255, 255 };
+                    int minx, maxx, miny, maxy;
+                    TTF_Font* font = fontPool->ThreadFont();
+                    auto surface = font ? TTF_RenderGlyph_Blended(font, item.ch, white) : nullptr;
+                    if (surface)
                     {
-                        for (int x = 0; x < surface->w; x++)
+                        SDL_LockSurface(surface);
+                        TTF_GetGlyphMetrics(font, item.ch, &minx, &maxx, &miny, &maxy, &advance);
+
+                        // copy the alpha of the rendered glyph into an A8 pixel block
+                        item.pb_scaledSDF.Allocate(surface->w, surface->h, PixelFormat::A8);
+                        for (int y = 0; y < surface->h; y++)
                         {
-                            u32* src = (u32*)((u8*)surface->pixels + surface->pitch * y + x * 4);
-                            u32* dest = item.pb_scaledSDF.pixels + surface->w * y + x;
-                            *dest = (*src & 0xff000000) | 0x00ffffff;
+                            const u32* src = (const u32*)((u8*)surface->pixels + surface->pitch * y);
+                            u8* dest = item.pb_scaledSDF.Row(y);
+                            for (int x = 0; x < surface->w; x++)
+                            {
+                                dest[x] = (u8)(src[x] >> 24);
+                            }
                         }
+                        SDL_UnlockSurface(surface);
+                        SDL_DestroySurface(surface);
                     }
-                    item.pb_scaledSDF.CalcCropRect();
-//                    item.pb_scaledSDF.Dump();
-                    item.scaledSize = fontSize;
+                    else
+                    {
+                        item.pb_scaledSDF.Free();
+                    }
+                }
 
+                // whatever a cancelled kernel left behind is thrown away
+                if (JobCancelled())
+                {
+                    item.pb_scaledSDF.Free();
+                    return;
+                }
+
+                {
+                    TraceScope traceCrop("crop");
+                    item.pb_scaledSDF.CalcCropRect();
+                    if (preview && item.pb_scaledSDF.crop_w > 0)
+                    {
+                        // detail too thin for the 1x raster still shows up in the refined SDF, so the page rect gets a margin for it
+                        PixelBlock& pb = item.pb_scaledSDF;
+                        int x0 = std::max(pb.crop_x - 2, 0);
+                        int y0 = std::max(pb.crop_y - 2, 0);
+                        pb.crop_w = std::min(pb.crop_x + pb.crop_w + 2, pb.w) - x0;
+                        pb.crop_h = std::min(pb.crop_y + pb.crop_h + 2, pb.h) - y0;
+                        pb.crop_x = x0;
+                        pb.crop_y = y0;
+                    }
+                }
+//                item.pb_scaledSDF.Dump();
+                item.scaledSize = fontSize;
+                item.advance = advance;
+                if (item.pb_scaledSDF.crop_w > 0)
+                {
                     // calculate the render size and offsets
                     int croppedX = item.pb_scaledSDF.crop_x;
                     int croppedY = item.pb_scaledSDF.h - item.pb_scaledSDF.crop_y - item.pb_scaledSDF.crop_h;
                     item.w = item.pb_scaledSDF.crop_w;
                     item.h = item.pb_scaledSDF.crop_h;
 
-                    item.xoffset = -(fontSize / 8);
-                    item.yoffset = croppedY - (item.pb_scaledSDF.h - fontSize);
-                    item.advance = advance;
-//                    SDL_Log("Glyph %c : %d,%d, %d,%d -> %d,%d,%d,%d -> %d,%d", item.ch, minx, miny, maxx, maxy,
+                    if (glyphRaster)
+                    {
+                        // our blocks know exactly where the pen and baseline are
+                        int originX, baseline;
+                        glyphRaster->GlyphOrigin(item.ch, (float)fontSize, padding, originX, baseline);
+                        item.xoffset = croppedX - originX;
+                        item.yoffset = baseline - (item.pb_scaledSDF.crop_y + item.pb_scaledSDF.crop_h);
+                    }
+                    else
+                    {
+                        // the SDL_ttf surface only gives an estimate
+                        item.xoffset = -(fontSize / 8);
+                        item.yoffset = croppedY - (item.pb_scaledSDF.h - fontSize);
+                    }
+//                    SDL_Log("Glyph %c : %d,%d, %d,%d -> %d,%d", item.ch,
 //                        item.pb_scaledSDF.crop_x, item.pb_scaledSDF.crop_y, item.pb_scaledSDF.crop_w, item.pb_scaledSDF.crop_h, item.xoffset, item.yoffset);
 
                     // add it to the atlas
@@ -749,28 +914,89 @@ void Project::GenerateCharSDF(FontChar& item)
 
                     // free all memory except for the scaled SDF - we do that AFTER the atlas layout
                     // this means we do need to retain all scaled SDF memory for all characters at once
-                    // but even a 22000 character chinese font will be about 400meg.
-                    ttf_access.lock();
-                    SDL_UnlockSurface(surface);
-                    SDL_DestroySurface(surface);
-                    ttf_access.unlock();
+                    // but even a 22000 character chinese font will be about 400meg - a streaming bake only holds two batches
                 }
                 else
                 {
                     // empty block like a SPACE
+                    item.pb_scaledSDF.Free();
                     item.w = 0;
                     item.h = 0;
                     item.xoffset = 0;
                     item.yoffset = 0;
-                    item.scaledSize = fontSize;
                 }
             };
-        QueueAsyncTaskHP(func);
+}
+
+// full quality SDF for a glyph already on a preview page - it has the same layout, so the same rect is copied over the preview
+std::function<void(FontChar&)> Project::RefineCharTask()
+{
+    SDFEngine engine = m_glyphEngine == GlyphEngine::Coverage ? SDFEngine::Coverage : SDFEngine::RowScan;
+    return [fontSize = m_fontSize, &atlas = m_atlas, glyphRaster = m_glyphRaster, range = SDFOutputRange(),
+        supersample = m_supersample, engine, filter = m_resampleFilter, msdf = UseMSDF()](FontChar& item)
+        {
+            TraceScope trace("refine");
+            PixelBlock block;
+            int advance;
+            if (msdf)
+                glyphRaster->RenderMSDF(item.ch, (float)fontSize, range, block, advance);
+            else
+                glyphRaster->RenderSupersampledSDF(item.ch, (float)fontSize, range, supersample, engine, filter, block, advance);
+            if (!JobCancelled())
+                atlas.UpdateBlock(&item, block);
+            block.Free();
+        };
+}
+
+// stops this project's bake where it is - other projects' jobs carry on
+void Project::CancelJobs()
+{
+    if (m_sdfJob)
+        m_sdfJob->Cancel();
+    if (m_refineJob)
+        m_refineJob->Cancel();
+    if (m_generateSDFTask)
+    {
+        if (m_generateSDFTask->joinable())
+            m_generateSDFTask->join();
+        delete m_generateSDFTask;
+        m_generateSDFTask = nullptr;
+    }
+    WaitForJobs();
+
+    if (m_generatingSDF)
+    {
+        for (auto& ch : m_chars)
+        {
+            ch.pb_scaledSDF.Free();
+        }
+        m_generatingSDF = false;
+        m_finishedGeneratingSDF = false;
+    }
+}
+
+void Project::WaitForJobs()
+{
+    if (m_sdfJob)
+        m_sdfJob->Wait();
+    if (m_refineJob)
+        m_refineJob->Wait();
+}
+
+bool Project::IsRefining() const
+{
+    return m_refineJob && m_refineJob->Remaining() > 0;
+}
+
+// under 2 pixels the MSDF channels can't hold a corner, so that's the least it gets
+int Project::SDFOutputRange() const
+{
+    return std::clamp(m_sdfRange, UseMSDF() ? 2 : 1, SDFMaxRange);
 }
 
 void Project::SetFont(const std::string& path, SDL_Renderer* renderer)
 {
-    AbortAsyncTasks();
+    CancelJobs();
 
     m_ttf_name = path;
     GenerateFont(renderer);
@@ -787,6 +1013,9 @@ void Project::AskForFont(SDL_Renderer* renderer)
     }
 }
 
+// glyphs per batch of a streaming bake - big enough to keep every worker busy, small enough that two batches of SDFs are nothing
+static const size_t StreamBatchGlyphs = 1024;
+
 void Project::GenerateSDF(SDL_Renderer* renderer)
 {
     if (m_generatingSDF)
@@ -797,42 +1026,161 @@ void Project::GenerateSDF(SDL_Renderer* renderer)
         if (m_generateSDFTask->joinable())
             m_generateSDFTask->join();
         delete m_generateSDFTask;
+        m_generateSDFTask = nullptr;
     }
 
-    if (m_ttf_font_large)
+    if (m_ttf_name.empty())
+        return;
+
+    // nothing can still be using the old fonts once our own tasks are done - other projects' tasks don't touch them
+    WaitForJobs();
+
+    delete m_fontPool;
+    delete m_glyphRaster;
+    m_fontPool = nullptr;
+    m_glyphRaster = nullptr;
+
+    // only SDL_ttf's own SDF render needs SDL_ttf, everything else comes from stb_truetype
+    if (m_applySDF && !UseMSDF() && !UseGlyphEngine())
     {
-        TTF_CloseFont(m_ttf_font_large);
-        m_ttf_font_large = TTF_OpenFont(m_ttf_name.c_str(), (float)m_fontSize);
-        TTF_SetFontSDF(m_ttf_font_large, m_applySDF ? true : false);
+        m_fontPool = new FontPool(m_ttf_name, (float)m_fontSize, true);
+        if (!m_fontPool->IsValid())
+        {
+            delete m_fontPool;
+            m_fontPool = nullptr;
+            return;
+        }
+    }
+    else
+    {
+        m_glyphRaster = new GlyphRaster(m_ttf_name);
+        if (!m_glyphRaster->IsValid())
+        {
+            delete m_glyphRaster;
+            m_glyphRaster = nullptr;
+            return;
+        }
     }
-
-    if (!m_ttf_font_large)
-        return;
 
     m_generatingSDF = true;
     m_finishedGeneratingSDF = false;
-
-    // now wait for all tasks to finish
-    WaitForAsyncTasks();
+    m_sdfJob = std::make_shared<TaskGroup>();
+    m_refineJob = std::make_shared<TaskGroup>();
+    m_glyphsUnqueued = 0;
 
     auto generateTask = [this]()
         {
+            TraceThreadName("generate " + m_name);
             // clears the atlas ready to build it again
-            m_atlas.StartLayout(m_pageWidth, m_pageHeight, m_padding);
+            if (UseMSDF())
+                m_atlas.StartLayout(m_pageWidth, m_pageHeight, m_padding, PixelFormat::ARGB8888, 0);
+            else
+                m_atlas.StartLayout(m_pageWidth, m_pageHeight, m_padding);
+
+            // a slow glyph engine or MSDF gets a 1x preview atlas first and the real SDFs replace its glyphs as they finish
+            // SDL_ttf lays out its own glyph surfaces, so nothing quicker would land in the same place on the page
+            bool refine = (UseSupersample() && m_supersample > 1) || UseMSDF();
 
-            // first make sure every selected character has a highrez font and an SDF
+            // longest job first so no big glyph is left running alone at the end - the farm claims indices in order
+            // the box height orders a streaming bake's batches
+            struct GlyphJob
+            {
+                float cost;
+                int height;
+                FontChar* item;
+            };
+            GlyphRaster* costRaster = m_glyphRaster ? m_glyphRaster : new GlyphRaster(m_ttf_name);
+            std::vector<GlyphJob> jobs;
             for (auto& item : m_chars)
             {
-                if (item.selected)
+                if (!item.selected)
+                    continue;
+                GlyphJob job = { 0.0f, 0, &item };
+                if (costRaster->IsValid())
+                {
+                    int width;
+                    costRaster->GlyphBox(item.ch, (float)m_fontSize, width, job.height);
+                    job.cost = costRaster->EstimateCost(item.ch, (float)m_fontSize);
+                }
+                jobs.push_back(job);
+            }
+            if (costRaster != m_glyphRaster)
+                delete costRaster;
+            auto byCost = [](const GlyphJob& a, const GlyphJob& b) { return a.cost > b.cost; };
+
+            // the glyphs of jobs[begin, end) in one submit, largest first
+            auto sdfTask = CharSDFTask(refine);
+            auto queueGlyphs = [&](size_t begin, size_t end, const JobHandle& job)
                 {
-                    GenerateCharSDF(item);
+                    std::vector<GlyphJob> sorted(jobs.begin() + begin, jobs.begin() + end);
+                    std::stable_sort(sorted.begin(), sorted.end(), byCost);
+                    std::vector<FontChar*> glyphs;
+                    for (auto& sortedJob : sorted)
+                        glyphs.push_back(sortedJob.item);
+                    QueueAsyncForHP((int)glyphs.size(), [glyphs, sdfTask](int i) { sdfTask(*glyphs[i]); }, job);
+                };
+
+            if (m_streamBake)
+            {
+                // bounded batches, shortest glyphs first like LayoutBlocks sorts them, so packing batch by batch stays close to all at once
+                // a batch is laid out, copied to its page and freed while the next one renders - only two batches of SDFs are held at a time
+                std::stable_sort(jobs.begin(), jobs.end(), [](const GlyphJob& a, const GlyphJob& b) { return a.height < b.height; });
+                m_glyphsUnqueued = (int)jobs.size();
+                auto queueBatch = [&](size_t begin)
+                    {
+                        JobHandle batch = std::make_shared<TaskGroup>(m_sdfJob);
+                        size_t end = std::min(begin + StreamBatchGlyphs, jobs.size());
+                        queueGlyphs(begin, end, batch);
+                        m_glyphsUnqueued -= (int)(end - begin);
+                        return batch;
+                    };
+                JobHandle batch = queueBatch(0);
+                for (size_t begin = 0; begin < jobs.size(); begin += StreamBatchGlyphs)
+                {
+                    JobHandle next = begin + StreamBatchGlyphs < jobs.size() ? queueBatch(begin + StreamBatchGlyphs) : nullptr;
+                    {
+                        TraceScope trace("wait glyphs");
+                        batch->Wait();
+                    }
+                    if (m_sdfJob->IsCancelled())
+                        break;
+                    {
+                        TraceScope trace("layout");
+                        m_atlas.LayoutBlocks(true);
+                    }
+                    batch = next;
+                }
+            }
+            else
+            {
+                // every selected character in one submit, laid out together once they're all done
+                queueGlyphs(0, jobs.size(), m_sdfJob);
+                {
+                    TraceScope trace("wait glyphs");
+                    m_sdfJob->Wait();
+                }
+                if (!m_sdfJob->IsCancelled())
+                {
+                    TraceScope trace("layout");
+                    m_atlas.LayoutBlocks();
                 }
             }
 
-            // now wait for all tasks to finish
-            WaitForAsyncTasks();
+            // CancelJobs cleans up after a cancelled bake
+            if (m_sdfJob->IsCancelled())
+                return;
 
-            m_atlas.LayoutBlocks();
+            if (refine)
+            {
+                // the refine tasks outlive this thread, so they get their own copy of the list
+                std::vector<FontChar*> glyphs;
+                for (auto& job : jobs)
+                {
+                    if (job.item->w > 0)
+                        glyphs.push_back(job.item);
+                }
+                QueueAsyncForLP((int)glyphs.size(), [glyphs, task = RefineCharTask()](int i) { task(*glyphs[i]); }, m_refineJob);
+            }
 
             m_finishedGeneratingSDF = true;
         };
@@ -3,8 +3,22 @@
 #include "types.h"
 #include "Atlas.h"
 #include "FontChar.h"
+#include <atomic>
+#include <thread>
 
 class Shad;
+class FontPool;
+class GlyphRaster;
+
+// where SDF mode gets its distance field from - saved as an int, so only add to the end
+enum class GlyphEngine : int
+{
+    TTF,            // SDL_ttf's own SDF render, one font per worker
+    Supersampled,   // stb_truetype raster m_supersample times larger, thresholded mask distance, box filtered down
+    Coverage,       // anti-aliased raster m_supersample times larger with the coverage aware engine - needs a smaller factor
+    Outline,        // analytic distance straight from the outline, no raster
+    Count
+};
 
 class Project
 {
@@ -20,11 +34,23 @@ public:
     void SaveAs();
     bool Gui(SDL_Renderer* renderer);
     void GenerateSDF(SDL_Renderer* renderer);
-    void GenerateCharSDF(FontChar& item);
+    // preview renders the glyph engines at 1x for a quick first atlas, RefineCharTask then replaces it on the page
+    std::function<void(FontChar&)> CharSDFTask(bool preview = false);
+    std::function<void(FontChar&)> RefineCharTask();
+    // blocks until this project's queued glyph tasks are done, other projects carry on
+    void WaitForJobs();
+    void CancelJobs();
+    bool IsRefining() const;
     bool CloseRequested() { return !m_open; }
     void Export();
     void SetRenderer(SDL_Renderer* renderer);
     void GenerateCharItem(FontChar& item, SDL_Renderer* renderer);
+    bool UseMSDF() const { return m_applySDF && m_msdf; }
+    bool UseGlyphEngine() const { return m_applySDF && !m_msdf && m_glyphEngine != GlyphEngine::TTF; }
+    // only the SDFs we generate ourselves take m_sdfRange - SDL_ttf's SDF render has a fixed spread
+    bool UseSupersample() const { return UseGlyphEngine() && m_glyphEngine != GlyphEngine::Outline; }
+    bool UseSDFRange() const { return UseMSDF() || UseGlyphEngine(); }
+    int SDFOutputRange() const;
 
     const std::string& Name() { return m_name; }
     const std::string& Path() { return m_path; }
@@ -39,7 +65,8 @@ private:
     std::string m_ttf_name;
 
     TTF_Font* m_ttf_font_small = nullptr;       // 32 point font for preview
-    TTF_Font* m_ttf_font_large = nullptr;       // 512 point font for SDF generation
+    FontPool* m_fontPool = nullptr;             // per worker fonts for SDL_ttf SDF generation
+    GlyphRaster* m_glyphRaster = nullptr;       // shared stb_truetype rasteriser for everything SDL_ttf doesn't do
 
     std::vector<FontChar> m_chars;
     bool m_open = true;
@@ -56,15 +83,23 @@ private:
 
     bool m_foldChars = false;
     bool m_applySDF = false;
+    bool m_msdf = false;            // with m_applySDF - multi channel SDF from the outlines into RGB pages
+    GlyphEngine m_glyphEngine = GlyphEngine::TTF;   // with m_applySDF and not m_msdf
+    int m_supersample = 8;          // raster scale for the Supersampled and Coverage engines
+    ResampleFilter m_resampleFilter = ResampleFilter::Box;  // how those engines scale the raster SDF down
+    bool m_streamBake = false;      // lay out and free glyphs in batches as they finish instead of holding every SDF until the end
 
     int m_fontSize = 16;
     int m_pageWidth = 512;
     int m_pageHeight = 512;
     int m_linePadding = 2;
     int m_padding = 2;
+    int m_sdfRange = SDFDefaultOutputRange;     // in atlas pixels, when UseSDFRange
 
-    std::mutex m_ttf_access;
     bool m_generatingSDF = false;
     bool m_finishedGeneratingSDF = false;
+    JobHandle m_sdfJob;             // this project's glyph SDF tasks
+    std::atomic<int> m_glyphsUnqueued{ 0 };    // glyphs of a streaming bake whose batch isn't queued yet
+    JobHandle m_refineJob;          // full quality SDFs still to replace preview glyphs
     std::thread* m_generateSDFTask = nullptr;
 };
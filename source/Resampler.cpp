@@ -0,0 +1,314 @@
+#include "Resampler.h"
+#include "PixelBlock.h"
+#include "Simd.h"
+#include "SDL3/SDL.h"
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+
+
+// an empty axis for a zero sized side - there's no scale to build taps from
+static bool BuildEmptyAxis(ResampleAxis& axis, int srcSize, int dstSize)
+{
+    if (srcSize > 0 && dstSize > 0)
+        return false;
+    axis.srcSize = std::max(srcSize, 0);
+    axis.dstSize = std::max(dstSize, 0);
+    axis.maxCount = 0;
+    axis.start.clear();
+    axis.count.clear();
+    axis.weights.clear();
+    return true;
+}
+
+void BuildBoxAxis(ResampleAxis& axis, int srcSize, int dstSize)
+{
+    if (BuildEmptyAxis(axis, srcSize, dstSize))
+        return;
+
+    axis.srcSize = srcSize;
+    axis.dstSize = dstSize;
+    axis.start.resize(dstSize);
+    axis.count.resize(dstSize);
+
+    // each output pixel covers 'scale' source pixels - one extra tap for a partial pixel at either end
+    double scale = (double)srcSize / dstSize;
+    axis.maxCount = (int)ceil(scale) + 1;
+    axis.weights.assign(dstSize * axis.maxCount, 0.0f);
+
+    for (int o = 0; o < dstSize; o++)
+    {
+        double a = o * scale;
+        double b = (o + 1) * scale;
+        int first = std::min((int)floor(a), srcSize - 1);
+        int last = std::min((int)ceil(b) - 1, srcSize - 1);
+        last = std::max(last, first);
+
+        float* weights = &axis.weights[o * axis.maxCount];
+        double total = 0.0;
+        for (int i = first; i <= last; i++)
+        {
+            double coverage = std::min(b, (double)(i + 1)) - std::max(a, (double)i);
+            weights[i - first] = (float)std::max(coverage, 0.0);
+            total += weights[i - first];
+        }
+        for (int i = 0; i <= last - first; i++)
+            weights[i] = total > 0.0 ? (float)(weights[i] / total) : 1.0f;
+
+        axis.start[o] = first;
+        axis.count[o] = last - first + 1;
+    }
+}
+
+static double MitchellWeight(double x)
+{
+    const double B = 1.0 / 3.0;
+    const double C = 1.0 / 3.0;
+    x = fabs(x);
+    if (x < 1.0)
+        return ((12 - 9 * B - 6 * C) * x * x * x + (-18 + 12 * B + 6 * C) * x * x + (6 - 2 * B)) / 6.0;
+    if (x < 2.0)
+        return ((-B - 6 * C) * x * x * x + (6 * B + 30 * C) * x * x + (-12 * B - 48 * C) * x + (8 * B + 24 * C)) / 6.0;
+    return 0.0;
+}
+
+static double Sinc(double x)
+{
+    if (x == 0.0)
+        return 1.0;
+    x *= 3.14159265358979323846;
+    return sin(x) / x;
+}
+
+static double LanczosWeight(double x)
+{
+    x = fabs(x);
+    return x < 3.0 ? Sinc(x) * Sinc(x / 3.0) : 0.0;
+}
+
+void BuildKernelAxis(ResampleAxis& axis, ResampleFilter filter, int srcSize, int dstSize)
+{
+    if (BuildEmptyAxis(axis, srcSize, dstSize))
+        return;
+    if (filter == ResampleFilter::Box)
+    {
+        BuildBoxAxis(axis, srcSize, dstSize);
+        return;
+    }
+
+    double radius = filter == ResampleFilter::Mitchell ? 2.0 : 3.0;
+    auto kernel = filter == ResampleFilter::Mitchell ? MitchellWeight : LanczosWeight;
+
+    // shrinking stretches the kernel over 'scale' source pixels so it also low passes
+    double scale = (double)srcSize / dstSize;
+    double stretch = std::max(scale, 1.0);
+    double support = radius * stretch;
+
+    axis.srcSize = srcSize;
+    axis.dstSize = dstSize;
+    axis.start.resize(dstSize);
+    axis.count.resize(dstSize);
+    axis.maxCount = (int)ceil(support * 2.0) + 1;
+    axis.weights.assign(dstSize * axis.maxCount, 0.0f);
+
+    std::vector<double> w(axis.maxCount);
+    for (int o = 0; o < dstSize; o++)
+    {
+        double center = (o + 0.5) * scale - 0.5;
+        int first = std::max((int)ceil(center - support), 0);
+        int last = std::min((int)floor(center + support), srcSize - 1);
+        last = std::min(std::max(last, first), first + axis.maxCount - 1);
+
+        float* weights = &axis.weights[o * axis.maxCount];
+        double total = 0.0;
+        for (int i = first; i <= last; i++)
+        {
+            w[i - first] = kernel((i - center) / stretch);
+            total += w[i - first];
+        }
+        for (int i = 0; i <= last - first; i++)
+            weights[i] = total != 0.0 ? (float)(w[i] / total) : 1.0f;
+
+        axis.start[o] = first;
+        axis.count[o] = last - first + 1;
+    }
+}
+
+// tables one thread keeps before starting over - enough for every glyph size pair of a bake or two
+static const size_t ResampleCacheSize = 256;
+
+std::shared_ptr<const ResampleAxis> GetResampleAxis(ResampleFilter filter, int srcSize, int dstSize)
+{
+    static thread_local std::map<u64, std::shared_ptr<const ResampleAxis>> t_axes;
+
+    u64 key = ((u64)filter << 48) | ((u64)(u32)srcSize << 24) | (u64)(u32)dstSize;
+    auto found = t_axes.find(key);
+    if (found != t_axes.end())
+        return found->second;
+
+    if (t_axes.size() >= ResampleCacheSize)
+        t_axes.clear();
+    auto axis = std::make_shared<ResampleAxis>();
+    BuildKernelAxis(*axis, filter, srcSize, dstSize);
+    t_axes[key] = axis;
+    return axis;
+}
+
+// out[0..n) = sum of rows[j][0..n) * weights[j] - all rows are summed per block so each output is stored once
+static void FilterRows(float* out, const u8* const* rows, const float* weights, int count, int n)
+{
+    int i = 0;
+#if defined(SIMD_AVX2)
+    for (; i + 16 <= n; i += 16)
+    {
+        __m256 a0 = _mm256_setzero_ps();
+        __m256 a1 = _mm256_setzero_ps();
+        for (int j = 0; j < count; j++)
+        {
+            __m256 wv = _mm256_set1_ps(weights[j]);
+            __m128i bytes = _mm_loadu_si128((const __m128i*)(rows[j] + i));
+            a0 = _mm256_add_ps(a0, _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(bytes)), wv));
+            a1 = _mm256_add_ps(a1, _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(_mm_srli_si128(bytes, 8))), wv));
+        }
+        _mm256_storeu_ps(out + i, a0);
+        _mm256_storeu_ps(out + i + 8, a1);
+    }
+#elif defined(SIMD_SSE2)
+    __m128i zero = _mm_setzero_si128();
+    for (; i + 16 <= n; i += 16)
+    {
+        __m128 a0 = _mm_setzero_ps();
+        __m128 a1 = _mm_setzero_ps();
+        __m128 a2 = _mm_setzero_ps();
+        __m128 a3 = _mm_setzero_ps();
+        for (int j = 0; j < count; j++)
+        {
+            __m128 wv = _mm_set1_ps(weights[j]);
+            __m128i bytes = _mm_loadu_si128((const __m128i*)(rows[j] + i));
+            __m128i lo = _mm_unpacklo_epi8(bytes, zero);
+            __m128i hi = _mm_unpackhi_epi8(bytes, zero);
+            a0 = _mm_add_ps(a0, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(lo, zero)), wv));
+            a1 = _mm_add_ps(a1, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(lo, zero)), wv));
+            a2 = _mm_add_ps(a2, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(hi, zero)), wv));
+            a3 = _mm_add_ps(a3, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(hi, zero)), wv));
+        }
+        _mm_storeu_ps(out + i, a0);
+        _mm_storeu_ps(out + i + 4, a1);
+        _mm_storeu_ps(out + i + 8, a2);
+        _mm_storeu_ps(out + i + 12, a3);
+    }
+#elif defined(SIMD_NEON)
+    for (; i + 16 <= n; i += 16)
+    {
+        float32x4_t a0 = vdupq_n_f32(0.0f);
+        float32x4_t a1 = vdupq_n_f32(0.0f);
+        float32x4_t a2 = vdupq_n_f32(0.0f);
+        float32x4_t a3 = vdupq_n_f32(0.0f);
+        for (int j = 0; j < count; j++)
+        {
+            float32x4_t wv = vdupq_n_f32(weights[j]);
+            uint8x16_t bytes = vld1q_u8(rows[j] + i);
+            uint16x8_t lo = vmovl_u8(vget_low_u8(bytes));
+            uint16x8_t hi = vmovl_u8(vget_high_u8(bytes));
+            a0 = vmlaq_f32(a0, vcvtq_f32_u32(vmovl_u16(vget_low_u16(lo))), wv);
+            a1 = vmlaq_f32(a1, vcvtq_f32_u32(vmovl_u16(vget_high_u16(lo))), wv);
+            a2 = vmlaq_f32(a2, vcvtq_f32_u32(vmovl_u16(vget_low_u16(hi))), wv);
+            a3 = vmlaq_f32(a3, vcvtq_f32_u32(vmovl_u16(vget_high_u16(hi))), wv);
+        }
+        vst1q_f32(out + i, a0);
+        vst1q_f32(out + i + 4, a1);
+        vst1q_f32(out + i + 8, a2);
+        vst1q_f32(out + i + 12, a3);
+    }
+#endif
+    for (; i < n; i++)
+    {
+        float sum = 0.0f;
+        for (int j = 0; j < count; j++)
+            sum += rows[j][i] * weights[j];
+        out[i] = sum;
+    }
+}
+
+// sum of a[0..n) * b[0..n)
+static float Dot(const float* a, const float* b, int n)
+{
+    int i = 0;
+    float sum = 0.0f;
+#if defined(SIMD_AVX2)
+    __m256 acc = _mm256_setzero_ps();
+    for (; i + 8 <= n; i += 8)
+        acc = _mm256_add_ps(acc, _mm256_mul_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i)));
+    __m128 half = _mm_add_ps(_mm256_castps256_ps128(acc), _mm256_extractf128_ps(acc, 1));
+    half = _mm_add_ps(half, _mm_movehl_ps(half, half));
+    half = _mm_add_ss(half, _mm_shuffle_ps(half, half, 1));
+    sum = _mm_cvtss_f32(half);
+#elif defined(SIMD_SSE2)
+    __m128 acc = _mm_setzero_ps();
+    for (; i + 4 <= n; i += 4)
+        acc = _mm_add_ps(acc, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+    acc = _mm_add_ps(acc, _mm_movehl_ps(acc, acc));
+    acc = _mm_add_ss(acc, _mm_shuffle_ps(acc, acc, 1));
+    sum = _mm_cvtss_f32(acc);
+#elif defined(SIMD_NEON)
+    float32x4_t acc = vdupq_n_f32(0.0f);
+    for (; i + 4 <= n; i += 4)
+        acc = vmlaq_f32(acc, vld1q_f32(a + i), vld1q_f32(b + i));
+    sum = vaddvq_f32(acc);
+#endif
+    for (; i < n; i++)
+        sum += a[i] * b[i];
+    return sum;
+}
+
+void ResampleRow(u8* out, const u8* const* rows, int y, int channels, const ResampleAxis& xAxis, const ResampleAxis& yAxis, float* column)
+{
+    // vertical pass - whole source rows at a time, which is where nearly all the work is when shrinking
+    FilterRows(column, rows, &yAxis.weights[y * yAxis.maxCount], yAxis.count[y], xAxis.srcSize * channels);
+
+    // horizontal pass over the one filtered row - single channel taps are contiguous so they vectorise
+    if (channels == 1)
+    {
+        for (int x = 0; x < xAxis.dstSize; x++)
+        {
+            float sum = Dot(&column[xAxis.start[x]], &xAxis.weights[x * xAxis.maxCount], xAxis.count[x]);
+            out[x] = (u8)std::clamp((int)(sum + 0.5f), 0, 255);
+        }
+        return;
+    }
+    for (int x = 0; x < xAxis.dstSize; x++)
+    {
+        const float* wx = &xAxis.weights[x * xAxis.maxCount];
+        const float* in = &column[xAxis.start[x] * channels];
+        for (int c = 0; c < channels; c++)
+        {
+            float sum = 0.0f;
+            for (int i = 0; i < xAxis.count[x]; i++)
+                sum += in[i * channels + c] * wx[i];
+            out[x * channels + c] = (u8)std::clamp((int)(sum + 0.5f), 0, 255);
+        }
+    }
+}
+
+void Resample(PixelBlock& dest, const PixelBlock& source, int sx, int sy, const ResampleAxis& xAxis, const ResampleAxis& yAxis)
+{
+    SDL_assert(source.format == dest.format);
+    SDL_assert(xAxis.dstSize == dest.w && yAxis.dstSize == dest.h);
+    if (!xAxis.maxCount || !yAxis.maxCount)
+        return;
+
+    // channels are interleaved so both passes can treat a row as a flat run of bytes
+    const int channels = source.BytesPerPixel();
+    std::vector<float> column(xAxis.srcSize * channels);
+    std::vector<const u8*> rows(yAxis.maxCount);
+
+    for (int y = 0; y < dest.h; y++)
+    {
+        if (JobCancelled())
+            return;
+        for (int j = 0; j < yAxis.count[y]; j++)
+            rows[j] = source.Row(sy + yAxis.start[y] + j) + sx * channels;
+        ResampleRow(dest.Row(y), rows.data(), y, channels, xAxis, yAxis, column.data());
+    }
+}
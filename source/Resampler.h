@@ -0,0 +1,44 @@
+#pragma once
+
+#include "types.h"
+#include <memory>
+#include <vector>
+
+struct PixelBlock;
+
+// downscale filter used by PixelBlock::Scale
+enum class ResampleFilter
+{
+    Box,        // area average - cheap but softens SDF corners
+    Mitchell,   // bicubic B=C=1/3 - sharp without much ringing
+    Lanczos3    // windowed sinc, 3 lobes - sharpest, can ring slightly on hard edges
+};
+
+// filter taps for one axis - output pixel i reads count[i] source pixels starting at start[i]
+// weights are stored maxCount apart and each output pixel's weights sum to 1
+struct ResampleAxis
+{
+    int srcSize = 0;
+    int dstSize = 0;
+    int maxCount = 0;
+    std::vector<int> start;
+    std::vector<int> count;
+    std::vector<float> weights;
+};
+
+// area weighted box filter - partially covered source pixels contribute by how much of them is covered
+void BuildBoxAxis(ResampleAxis& axis, int srcSize, int dstSize);
+
+// Mitchell / Lanczos taps, widened by the scale factor when shrinking - taps past the edges are dropped and the rest renormalised
+void BuildKernelAxis(ResampleAxis& axis, ResampleFilter filter, int srcSize, int dstSize);
+
+// taps for a filter and size pair, built on first use - glyphs of one font mostly hit the same few sizes
+// cached per thread so lookups never take a lock, the handle keeps the table alive after the cache lets go of it
+std::shared_ptr<const ResampleAxis> GetResampleAxis(ResampleFilter filter, int srcSize, int dstSize);
+
+// one output row y from the yAxis.count[y] source rows it reads, each xAxis.srcSize pixels of 'channels' bytes
+// column is scratch space for xAxis.srcSize * channels floats
+void ResampleRow(u8* out, const u8* const* rows, int y, int channels, const ResampleAxis& xAxis, const ResampleAxis& yAxis, float* column);
+
+// separable resample of source sx,sy (axis srcSize wide/high) into all of dest - formats must match
+void Resample(PixelBlock& dest, const PixelBlock& source, int sx, int sy, const ResampleAxis& xAxis, const ResampleAxis& yAxis);
@@ -0,0 +1,193 @@
+#include "Trace.h"
+#include "SDL3/SDL.h"
+
+#include <algorithm>
+#include <chrono>
+#include <format>
+#include <fstream>
+#include <mutex>
+#include <vector>
+
+std::atomic<bool> g_traceEnabled{ false };
+
+// clock ticks at TraceStart - atomic as threads still finishing spans read it while a new trace starts
+static std::atomic<i64> g_traceEpoch{ 0 };
+
+struct TraceEvent
+{
+    const char* label;
+    u64 start;
+    u64 end;
+    u64 queued;
+    bool task;
+};
+
+// each thread records into its own list so tracing doesn't add a lock every thread fights over
+// a list outlives its thread so the events still get written, and is dropped at the next TraceStart
+struct TraceThread
+{
+    int id = 0;
+    std::string name;
+    std::mutex access;
+    std::vector<TraceEvent> events;
+    bool exited = false;
+};
+
+static std::mutex g_traceAccess;
+static std::vector<TraceThread*> g_traceThreads;
+static int g_traceNextId = 1;
+
+// marks the calling thread's list as done with when the thread exits
+struct TraceThreadOwner
+{
+    TraceThread* thread = nullptr;
+
+    ~TraceThreadOwner()
+    {
+        if (thread)
+        {
+            g_traceAccess.lock();
+            thread->exited = true;
+            g_traceAccess.unlock();
+        }
+    }
+};
+
+// the name is kept per thread until its first event, so threads that never record don't get a list
+static thread_local std::string t_traceName;
+static thread_local TraceThreadOwner t_traceThread;
+
+static TraceThread* ThisTraceThread()
+{
+    if (!t_traceThread.thread)
+    {
+        TraceThread* thread = new TraceThread;
+        thread->name = t_traceName;
+        g_traceAccess.lock();
+        thread->id = g_traceNextId++;
+        g_traceThreads.push_back(thread);
+        g_traceAccess.unlock();
+        t_traceThread.thread = thread;
+    }
+    return t_traceThread.thread;
+}
+
+u64 TraceNow()
+{
+    auto ticks = std::chrono::high_resolution_clock::duration(std::chrono::high_resolution_clock::now().time_since_epoch().count() - g_traceEpoch);
+    return (u64)std::max<i64>(std::chrono::duration_cast<std::chrono::microseconds>(ticks).count(), 0);
+}
+
+void TraceStart()
+{
+    g_traceAccess.lock();
+    // lists of threads that have gone only held events for the last trace
+    std::erase_if(g_traceThreads, [](TraceThread* thread)
+    {
+        bool exited = thread->exited;
+        if (exited)
+            delete thread;
+        return exited;
+    });
+    for (auto thread : g_traceThreads)
+    {
+        thread->access.lock();
+        thread->events.clear();
+        thread->access.unlock();
+    }
+    g_traceEpoch = std::chrono::high_resolution_clock::now().time_since_epoch().count();
+    g_traceAccess.unlock();
+    g_traceEnabled = true;
+}
+
+void TraceStop()
+{
+    g_traceEnabled = false;
+}
+
+void TraceThreadName(const std::string& name)
+{
+    t_traceName = name;
+    if (TraceThread* thread = t_traceThread.thread)
+    {
+        thread->access.lock();
+        thread->name = name;
+        thread->access.unlock();
+    }
+}
+
+static void AddEvent(const TraceEvent& event)
+{
+    TraceThread* thread = ThisTraceThread();
+    thread->access.lock();
+    thread->events.push_back(event);
+    thread->access.unlock();
+}
+
+void TraceSpan(const char* label, u64 start, u64 end)
+{
+    AddEvent({ label, start, end, 0, false });
+}
+
+void TraceTask(const char* label, u64 queued, u64 start, u64 end)
+{
+    AddEvent({ label, start, end, queued, true });
+}
+
+// thread names come from project names, so quotes, backslashes and control characters are escaped
+static std::string JsonEscape(const std::string& text)
+{
+    std::string escaped;
+    escaped.reserve(text.size());
+    for (char c : text)
+    {
+        if (c == '"' || c == '\\')
+        {
+            escaped += '\\';
+            escaped += c;
+        }
+        else if ((u8)c < 0x20)
+        {
+            escaped += "\\u00";
+            escaped += "0123456789abcdef"[(u8)c >> 4];
+            escaped += "0123456789abcdef"[c & 15];
+        }
+        else
+            escaped += c;
+    }
+    return escaped;
+}
+
+bool TraceWrite(const std::string& path)
+{
+    std::ofstream out(path);
+    if (!out)
+    {
+        SDL_Log("Trace: can't write %s", path.c_str());
+        return false;
+    }
+
+    // complete events, one row per thread - a queued task carries when it was queued and how long it waited
+    int count = 0;
+    out << "{\"traceEvents\":[";
+    g_traceAccess.lock();
+    for (auto thread : g_traceThreads)
+    {
+        thread->access.lock();
+        std::string name = thread->name.empty() ? std::format("thread {}", thread->id) : JsonEscape(thread->name);
+        out << std::format("{}\n{{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":{},\"args\":{{\"name\":\"{}\"}}}}",
+            count++ ? "," : "", thread->id, name);
+        for (auto& event : thread->events)
+        {
+            out << std::format(",\n{{\"name\":\"{}\",\"cat\":\"{}\",\"ph\":\"X\",\"pid\":1,\"tid\":{},\"ts\":{},\"dur\":{}",
+                event.label, event.task ? "task" : "stage", thread->id, event.start, event.end - event.start);
+            if (event.task)
+                out << std::format(",\"args\":{{\"queued\":{},\"wait\":{}}}", event.queued, event.start - std::min(event.queued, event.start));
+            out << "}";
+        }
+        thread->access.unlock();
+    }
+    g_traceAccess.unlock();
+    out << "\n]}\n";
+    return true;
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include "types.h"
+#include <atomic>
+#include <string>
+
+// opt in timeline of farm tasks and bake stages, written out as Chrome trace event JSON for chrome://tracing or Perfetto
+// off by default - every trace point is then a relaxed load and a branch
+extern std::atomic<bool> g_traceEnabled;
+
+inline bool TraceEnabled()
+{
+    return g_traceEnabled.load(std::memory_order_relaxed);
+}
+
+// microseconds since TraceStart
+u64 TraceNow();
+
+// drops anything recorded before and starts recording
+void TraceStart();
+void TraceStop();
+// everything recorded between TraceStart and TraceStop, returns false if the file can't be written
+bool TraceWrite(const std::string& path);
+
+// names the calling thread's row in the trace - cheap enough to call whether tracing is on or not
+void TraceThreadName(const std::string& name);
+
+// a finished stage on the calling thread - label has to outlive the trace, so string literals only
+void TraceSpan(const char* label, u64 start, u64 end);
+// a finished farm task with when it was queued, so the wait for a worker shows up too
+void TraceTask(const char* label, u64 queued, u64 start, u64 end);
+
+// the enclosing scope as a span, when tracing was on as it started
+class TraceScope
+{
+public:
+    TraceScope(const char* label) : m_label(label), m_active(TraceEnabled())
+    {
+        if (m_active)
+            m_start = TraceNow();
+    }
+
+    ~TraceScope()
+    {
+        if (m_active)
+            TraceSpan(m_label, m_start, TraceNow());
+    }
+
+private:
+    const char* m_label;
+    bool m_active;
+    u64 m_start = 0;
+};
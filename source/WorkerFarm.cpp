@@ -1,2 +1,4 @@
 #include "WorkerFarm.h"
 
+
+thread_local const std::atomic<bool>* t_jobCancel = nullptr;
@@ -1,96 +1,516 @@
 #pragma once
 
 #include "types.h"
+#include "Trace.h"
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <memory>
 #include <mutex>
 #include <semaphore>
+#include <thread>
 #include <vector>
 #include "SDL3/SDL.h"
 
 #undef max
 
+// tasks queued together so they can be waited on or cancelled without touching anything else on the farm
+// Wait blocks on the count itself, so a waiting thread only wakes when the last task of the group finishes
+class TaskGroup
+{
+public:
+	TaskGroup() = default;
+
+	// a group within parent that can be waited on by itself - its tasks count towards the parent too and they share a cancel flag
+	TaskGroup(const JobHandle& parent) : m_parent(parent), m_cancel(parent->m_cancel) {}
+
+	// queued tasks of the group are skipped, running ones see JobCancelled() and return early
+	void Cancel()
+	{
+		*m_cancel = true;
+	}
+
+	bool IsCancelled() const
+	{
+		return *m_cancel;
+	}
+
+	void Wait()
+	{
+		for (int pending = m_pending; pending > 0; pending = m_pending)
+			m_pending.wait(pending);
+	}
+
+	int Remaining() const
+	{
+		return m_pending;
+	}
+
+	// indices of the group's QueueFor ranges not run yet - progress in items rather than in helper tasks
+	int ItemsRemaining() const
+	{
+		return m_items;
+	}
+
+private:
+	friend class WorkerFarm;
+
+	void Add()
+	{
+		m_pending++;
+		if (m_parent)
+			m_parent->Add();
+	}
+
+	void Done()
+	{
+		if (--m_pending == 0)
+			m_pending.notify_all();
+		if (m_parent)
+			m_parent->Done();
+	}
+
+	void AddItems(int count)
+	{
+		m_items += count;
+		if (m_parent)
+			m_parent->AddItems(count);
+	}
+
+	void ItemsDone(int count)
+	{
+		m_items -= count;
+		if (m_parent)
+			m_parent->ItemsDone(count);
+	}
+
+	std::atomic<int> m_pending{ 0 };
+	std::atomic<int> m_items{ 0 };
+	JobHandle m_parent;
+	std::atomic<bool> m_cancelled{ false };
+	std::atomic<bool>* m_cancel = &m_cancelled;		// the top group's flag, kept alive by m_parent
+};
+
+// what a deque holds - the task and the group it reports to when done
+struct QueuedTask
+{
+	GenericTask func;
+	JobHandle job;
+	bool traced = false;
+	u64 queuedAt = 0;		// trace time it was queued, when traced
+};
+
+// Chase-Lev work stealing deque - only the owning worker pushes and takes at the bottom, any thread steals from the top
+// full arrays are replaced by one twice the size, old arrays are kept until the deque goes as a thief may still be reading them
+class TaskDeque
+{
+public:
+	TaskDeque()
+	{
+		m_arrays.push_back(new Array(256));
+		m_array = m_arrays.back();
+	}
+
+	~TaskDeque()
+	{
+		for (auto array : m_arrays)
+			delete array;
+	}
+
+	void Push(QueuedTask* task)
+	{
+		i64 b = m_bottom.load(std::memory_order_relaxed);
+		i64 t = m_top.load(std::memory_order_acquire);
+		Array* array = m_array.load(std::memory_order_relaxed);
+		if (b - t > array->size - 1)
+		{
+			Array* bigger = new Array(array->size * 2);
+			for (i64 i = t; i < b; i++)
+				bigger->Put(i, array->Get(i));
+			m_arrays.push_back(bigger);
+			m_array.store(bigger, std::memory_order_release);
+			array = bigger;
+		}
+		array->Put(b, task);
+		std::atomic_thread_fence(std::memory_order_release);
+		m_bottom.store(b + 1, std::memory_order_relaxed);
+	}
+
+	// newest task, or nullptr when empty
+	QueuedTask* Take()
+	{
+		i64 b = m_bottom.load(std::memory_order_relaxed) - 1;
+		Array* array = m_array.load(std::memory_order_relaxed);
+		m_bottom.store(b, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		i64 t = m_top.load(std::memory_order_relaxed);
+		QueuedTask* task = nullptr;
+		if (t <= b)
+		{
+			task = array->Get(b);
+			if (t == b)
+			{
+				// last task - race the thieves for it
+				if (!m_top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+					task = nullptr;
+				m_bottom.store(b + 1, std::memory_order_relaxed);
+			}
+		}
+		else
+		{
+			m_bottom.store(b + 1, std::memory_order_relaxed);
+		}
+		return task;
+	}
+
+	// oldest task, or nullptr when empty or another thread got there first
+	QueuedTask* Steal()
+	{
+		i64 t = m_top.load(std::memory_order_acquire);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		i64 b = m_bottom.load(std::memory_order_acquire);
+		if (t >= b)
+			return nullptr;
+		Array* array = m_array.load(std::memory_order_acquire);
+		QueuedTask* task = array->Get(t);
+		if (!m_top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+			return nullptr;
+		return task;
+	}
+
+private:
+	struct Array
+	{
+		Array(i64 count) : size(count), slots(new std::atomic<QueuedTask*>[count]) {}
+		~Array() { delete[] slots; }
+		QueuedTask* Get(i64 i) const { return slots[i & (size - 1)].load(std::memory_order_relaxed); }
+		void Put(i64 i, QueuedTask* task) { slots[i & (size - 1)].store(task, std::memory_order_relaxed); }
+
+		i64 size;
+		std::atomic<QueuedTask*>* slots;
+	};
+
+	alignas(64) std::atomic<i64> m_top{ 0 };
+	alignas(64) std::atomic<i64> m_bottom{ 0 };
+	std::atomic<Array*> m_array;
+	std::vector<Array*> m_arrays;		// only touched by the owner
+};
+
+// worker threads with a work stealing deque per priority each
+// tasks queued from a worker go on its own deques, everything else on a shared queue per priority that workers take batches from
+// a worker runs its own newest task first and steals the oldest from the others - high priority always before low
 class WorkerFarm
 {
 public:
-	WorkerFarm()
+	// threads 0 picks from the core count
+	WorkerFarm(int threads = 0)
 	{
 		u32 num_processors = std::thread::hardware_concurrency();
-		u32 spawnThreads = std::max((u32)1, num_processors - 2);
+		u32 spawnThreads = threads > 0 ? (u32)threads : num_processors > 3 ? num_processors - 2 : 1;
+		m_workers.resize(spawnThreads);
+		for (u32 i = 0; i < spawnThreads; i++)
+			m_workers[i] = new Worker;
 		for (u32 i = 0; i < spawnThreads; i++)
 		{
 			m_processors.push_back(new std::thread([this, i]() {Process(i); }));
 		}
 	}
 
+	~WorkerFarm()
+	{
+		m_quit = true;
+		m_semaphore.release(m_processors.size());
+		for (auto thread : m_processors)
+		{
+			thread->join();
+			delete thread;
+		}
+		for (auto worker : m_workers)
+		{
+			for (int priority = 0; priority < PriorityCount; priority++)
+			{
+				while (QueuedTask* task = worker->deques[priority].Take())
+					delete task;
+			}
+			delete worker;
+		}
+		for (int priority = 0; priority < PriorityCount; priority++)
+		{
+			for (auto task : m_shared[priority])
+				delete task;
+		}
+	}
+
 	void Process(int thread)
 	{
+		t_farm = this;
+		t_worker = thread;
+		TraceThreadName("worker " + std::to_string(thread));
 		for (;;)
 		{
+			// every release is one queued task, so once acquired there's a task somewhere to find
 			m_semaphore.acquire();
-			m_access.lock();
-			GenericTask task;
-			if (!m_highPriorityTasks.empty())
-			{
-				task = m_highPriorityTasks.back();
-				m_highPriorityTasks.pop_back();
-			}
-			else
+			if (m_quit)
+				return;
+
+			QueuedTask* task = nullptr;
+			while (!task)
+				task = FindTask(thread);
+
+			if (!task->job->IsCancelled())
 			{
-				task = m_lowPriorityTasks.back();
-				m_lowPriorityTasks.pop_back();
+				u64 start = task->traced ? TraceNow() : 0;
+				t_jobCancel = task->job->m_cancel;
+				task->func();
+				t_jobCancel = nullptr;
+				if (task->traced && TraceEnabled())
+					TraceTask("task", task->queuedAt, start, TraceNow());
 			}
-			m_access.unlock();
-			if (!m_abort)
-				task();
-			m_access.lock();
-			m_taskCount--;
-			m_access.unlock();
+			task->job->Done();
+			delete task;
 		}
 	}
 
-	void QueueLowPriorityTask(const GenericTask& task)
+	// job is the group the task joins - a new one is made when none is given, either way it's returned to wait on
+	// never wait on a job from one of its own tasks, the worker would be waiting on itself
+	JobHandle QueueLowPriorityTask(const GenericTask& task, const JobHandle& job = nullptr)
 	{
-		m_access.lock();
-		m_lowPriorityTasks.push_back(task);
-		m_taskCount++;
-		m_access.unlock();
-		m_semaphore.release();
+		return Queue(LowPriority, task, job);
+	}
+
+	JobHandle QueueHighPriorityTask(const GenericTask& task, const JobHandle& job = nullptr)
+	{
+		return Queue(HighPriority, task, job);
 	}
 
-	void QueueHighPriorityTask(const GenericTask& task)
+	// queues func(0..count-1) as at most a task per worker that claim indices in order, in chunks that shrink as the range runs out
+	// a helper keeps claiming while nothing else waits, and requeues itself behind waiting work of the same or higher priority
+	// between chunks, so one range can't hold every worker - returns the job like a single queued task
+	JobHandle QueueLowPriorityFor(int count, const std::function<void(int)>& func, const JobHandle& job = nullptr)
 	{
-		m_access.lock();
-		m_highPriorityTasks.push_back(task);
-		m_taskCount++;
-		m_access.unlock();
+		return QueueFor(LowPriority, count, func, job);
+	}
+
+	JobHandle QueueHighPriorityFor(int count, const std::function<void(int)>& func, const JobHandle& job = nullptr)
+	{
+		return QueueFor(HighPriority, count, func, job);
+	}
+
+	// runs func(0..count-1) on the farm and the calling thread, returns once every call is done
+	// the caller takes indices too, so it can be used from inside a task even when every worker is busy
+	void ParallelFor(int count, const std::function<void(int)>& func)
+	{
+		struct Shared
+		{
+			std::atomic<int> next{ 0 };
+			std::atomic<int> done{ 0 };
+			const std::function<void(int)>* func = nullptr;
+			int count = 0;
+			const std::atomic<bool>* cancel = nullptr;
+		};
+		auto shared = std::make_shared<Shared>();
+		shared->func = &func;
+		shared->count = count;
+		shared->cancel = t_jobCancel;
+
+		// helpers that start after every index is taken just return - func is only touched for a taken index
+		// they run under the caller's cancel flag so cancelling its job stops them too
+		auto work = [shared]()
+			{
+				const std::atomic<bool>* cancel = t_jobCancel;
+				t_jobCancel = shared->cancel;
+				for (;;)
+				{
+					int i = shared->next++;
+					if (i >= shared->count)
+						break;
+					(*shared->func)(i);
+					if (++shared->done == shared->count)
+						shared->done.notify_all();
+				}
+				t_jobCancel = cancel;
+			};
+		int helpers = std::min(count - 1, (int)m_processors.size());
+		JobHandle job;
+		for (int i = 0; i < helpers; i++)
+			job = QueueHighPriorityTask(work, job);
+		work();
+
+		// only indices a helper is still running are left - sleep until the last one finishes instead of spinning a core they could use
+		for (int done = shared->done; done < count; done = shared->done)
+			shared->done.wait(done);
+	}
+
+	int ThreadCount() const
+	{
+		return (int)m_processors.size();
+	}
+
+private:
+	enum Priority
+	{
+		HighPriority,
+		LowPriority,
+		PriorityCount
+	};
+
+	struct Worker
+	{
+		TaskDeque deques[PriorityCount];
+	};
+
+	// a QueueFor range - helpers claim chunks of indices in order from next
+	struct Range
+	{
+		std::atomic<int> next{ 0 };
+		std::atomic<int> queued{ 0 };		// helpers of this range waiting for a worker - not worth yielding to
+		int count = 0;
+		int divisor = 1;
+		Priority priority = HighPriority;
+		JobHandle job;
+		std::function<void(int)> func;
+	};
+
+	// most indices a helper claims at once, so waiting work never waits long for a chunk to finish
+	static const int RangeChunkMax = 8;
+
+	// shared puts the task at the back of the shared queue even from a worker, behind everything already waiting
+	JobHandle Queue(Priority priority, const GenericTask& task, const JobHandle& job, bool shared = false)
+	{
+		// a worker can finish and delete the task before this returns, so the handle is kept here
+		JobHandle group = job ? job : std::make_shared<TaskGroup>();
+		group->Add();
+		QueuedTask* queued = new QueuedTask{ task, group };
+		if (TraceEnabled())
+		{
+			queued->traced = true;
+			queued->queuedAt = TraceNow();
+		}
+		m_waiting[priority]++;
+		if (t_farm == this && !shared)
+		{
+			m_workers[t_worker]->deques[priority].Push(queued);
+		}
+		else
+		{
+			m_sharedAccess.lock();
+			m_shared[priority].push_back(queued);
+			m_sharedSize[priority]++;
+			m_sharedAccess.unlock();
+		}
 		m_semaphore.release();
+		return group;
 	}
 
-	void Abort()
+	JobHandle QueueFor(Priority priority, int count, const std::function<void(int)>& func, const JobHandle& job)
 	{
-		m_abort = true;
+		JobHandle group = job ? job : std::make_shared<TaskGroup>();
+		auto range = std::make_shared<Range>();
+		range->count = count;
+		range->divisor = (int)m_workers.size() * 4;
+		range->priority = priority;
+		range->job = group;
+		range->func = func;
+		group->AddItems(count);
+
+		int helpers = std::min(count, (int)m_workers.size());
+		range->queued = helpers;
+		for (int i = 0; i < helpers; i++)
+			Queue(priority, [this, range]() { RunRange(range); }, group);
+		return group;
 	}
 
-	void WaitForTasks()
+	// one helper's turn at a range - guided chunks, a quarter of a fair share each down to single indices at the end so nothing is left running alone
+	void RunRange(const std::shared_ptr<Range>& range)
 	{
-		while (m_taskCount > 0)
+		range->queued--;
+		for (;;)
 		{
-			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+			int chunk = std::clamp((range->count - range->next.load(std::memory_order_relaxed)) / range->divisor, 1, RangeChunkMax);
+			int begin = range->next.fetch_add(chunk);
+			int end = std::min(begin + chunk, range->count);
+			for (int i = begin; i < end; i++)
+			{
+				if (JobCancelled())
+					return;
+				range->func(i);
+			}
+			if (begin < end)
+				range->job->ItemsDone(end - begin);
+			if (end >= range->count)
+				return;
+
+			// the rest of the range goes behind whatever is waiting, on the shared queue so this worker doesn't take it straight back
+			if (WorkWaiting(range->priority, range->queued))
+			{
+				range->queued++;
+				Queue(range->priority, [this, range]() { RunRange(range); }, range->job, true);
+				return;
+			}
 		}
-		m_abort = false;
 	}
 
-	int TasksRemaining()
+	// more queued tasks of this priority or higher than 'own' that no worker has picked up yet
+	bool WorkWaiting(Priority priority, int own) const
 	{
-		return m_taskCount;
+		int waiting = 0;
+		for (int p = 0; p <= priority; p++)
+			waiting += m_waiting[p].load(std::memory_order_relaxed);
+		return waiting > own;
 	}
 
-private:
-	bool m_abort = false;
+	QueuedTask* FindTask(int thread)
+	{
+		for (int priority = 0; priority < PriorityCount; priority++)
+		{
+			QueuedTask* task = m_workers[thread]->deques[priority].Take();
+			if (!task)
+				task = TakeShared(thread, (Priority)priority);
+			for (size_t i = 1; i < m_workers.size() && !task; i++)
+				task = m_workers[(thread + i) % m_workers.size()]->deques[priority].Steal();
+			if (task)
+			{
+				m_waiting[priority]--;
+				return task;
+			}
+		}
+		return nullptr;
+	}
+
+	// oldest shared task, with a batch of the ones after it moved to this worker's deque so the others steal instead of locking
+	QueuedTask* TakeShared(int thread, Priority priority)
+	{
+		if (m_sharedSize[priority] == 0)
+			return nullptr;
+
+		m_sharedAccess.lock();
+		auto& shared = m_shared[priority];
+		QueuedTask* task = nullptr;
+		if (!shared.empty())
+		{
+			task = shared.front();
+			shared.pop_front();
+			size_t batch = std::min(shared.size() / m_workers.size(), (size_t)32);
+			TaskDeque& own = m_workers[thread]->deques[priority];
+			// pushed newest first so the owner's LIFO take still runs them oldest first
+			for (size_t i = batch; i > 0; i--)
+				own.Push(shared[i - 1]);
+			shared.erase(shared.begin(), shared.begin() + batch);
+			m_sharedSize[priority] = (int)shared.size();
+		}
+		m_sharedAccess.unlock();
+		return task;
+	}
+
+	static inline thread_local WorkerFarm* t_farm = nullptr;
+	static inline thread_local int t_worker = 0;
+
+	std::atomic<bool> m_quit{ false };
 	std::vector<std::thread *> m_processors;
-	std::vector<GenericTask> m_lowPriorityTasks;
-	std::vector<GenericTask> m_highPriorityTasks;
+	std::vector<Worker*> m_workers;
+	std::deque<QueuedTask*> m_shared[PriorityCount];
+	std::atomic<int> m_sharedSize[PriorityCount]{};
+	std::atomic<int> m_waiting[PriorityCount]{};		// queued and not yet taken, per priority
+	std::mutex m_sharedAccess;
 	std::counting_semaphore<> m_semaphore{ 0 };
-	std::mutex m_access;
-
-	volatile int m_taskCount = 0;
 };
@@ -29,6 +29,8 @@
 #include "Settings.h"
 #include "SHAD.h"
 #include "WorkerFarm.h"
+#include "Benchmark.h"
+#include "Trace.h"
 #include <filesystem>
 #include <fstream>
 #include <iostream>
@@ -55,30 +57,22 @@ void QueueMainThreadTask(const GenericTask& func)
 }
 
 WorkerFarm gWorkers;
-void QueueAsyncTaskLP(const GenericTask& func)
+JobHandle QueueAsyncTaskLP(const GenericTask& func, const JobHandle& job)
 {
-    gWorkers.QueueLowPriorityTask(func);
+    return gWorkers.QueueLowPriorityTask(func, job);
 }
-void QueueAsyncTaskHP(const GenericTask& func)
+JobHandle QueueAsyncTaskHP(const GenericTask& func, const JobHandle& job)
 {
-    gWorkers.QueueHighPriorityTask(func);
+    return gWorkers.QueueHighPriorityTask(func, job);
 }
-int GetAsyncTasksRemaining()
+JobHandle QueueAsyncForLP(int count, const std::function<void(int)>& func, const JobHandle& job)
 {
-    return gWorkers.TasksRemaining();
+    return gWorkers.QueueLowPriorityFor(count, func, job);
 }
-
-
-void WaitForAsyncTasks()
-{
-    gWorkers.WaitForTasks();
-}
-void AbortAsyncTasks()
+JobHandle QueueAsyncForHP(int count, const std::function<void(int)>& func, const JobHandle& job)
 {
-    gWorkers.Abort();
-    gWorkers.WaitForTasks();
+    return gWorkers.QueueHighPriorityFor(count, func, job);
 }
-
 // new project
 void NewProject(SDL_Renderer* renderer)
 {
@@ -158,6 +152,8 @@ int main(int, char**)
 
     gSettings.Load();
     InitPosCheckArray();
+    SetSDFParallelFor([](int count, const std::function<void(int)>& func) { gWorkers.ParallelFor(count, func); });
+    TraceThreadName("main");
 
 
     // Create window with SDL_Renderer graphics context
@@ -326,6 +322,45 @@ int main(int, char**)
                 {
                     QueueMainThreadTask([renderer]() { LoadProject(renderer); SaveSettings(); });
                 }
+                if (ImGui::MenuItem("Start Trace", nullptr, false, !TraceEnabled()))
+                {
+                    TraceStart();
+                }
+                if (ImGui::MenuItem("Stop Trace", nullptr, false, TraceEnabled()))
+                {
+                    TraceStop();
+                    QueueMainThreadTask([]()
+                        {
+                            const char* formats[] = { "*.json" };
+                            char* filename = tinyfd_saveFileDialog("Save Trace", "mpfont_trace.json", 1, formats, nullptr);
+                            if (filename)
+                                TraceWrite(filename);
+                        });
+                }
+                if (ImGui::MenuItem("Benchmark SDF Kernels"))
+                {
+                    QueueAsyncTaskLP([]() { BenchmarkSDFKernels(); });
+                }
+                if (ImGui::MenuItem("Benchmark Worker Farm"))
+                {
+                    QueueAsyncTaskLP([]() { BenchmarkWorkerFarm(); });
+                }
+                if (ImGui::MenuItem("Benchmark Job Wait"))
+                {
+                    QueueAsyncTaskLP([]() { BenchmarkJobWait(); });
+                }
+                if (ImGui::MenuItem("Benchmark Glyph Raster", nullptr, false, !g_projects.empty() && !g_projects.front()->TTFName().empty()))
+                {
+                    QueueAsyncTaskLP([ttf = g_projects.front()->TTFName()]() { BenchmarkGlyphRaster(ttf); });
+                }
+                if (ImGui::MenuItem("Benchmark Glyph Engines", nullptr, false, !g_projects.empty() && !g_projects.front()->TTFName().empty()))
+                {
+                    QueueAsyncTaskLP([ttf = g_projects.front()->TTFName()]() { BenchmarkGlyphEngines(ttf, 32); });
+                }
+                if (ImGui::MenuItem("Benchmark Glyph Schedule", nullptr, false, !g_projects.empty() && !g_projects.front()->TTFName().empty()))
+                {
+                    QueueAsyncTaskLP([ttf = g_projects.front()->TTFName()]() { BenchmarkGlyphSchedule(ttf, 64, 4); });
+                }
                 ImFont* font = ImGui::GetFont();
                 if (ImGui::DragFloat("Font scale", &font->Scale, 0.005f, 0.3f, 2.0f, "%.1f"))
                 {
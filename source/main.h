@@ -14,9 +14,10 @@ typedef std::function<void(void)> GenericTask;
 // save general gui and tool settings to appdata
 void SaveSettings();
 void QueueMainThreadTask(const GenericTask &func);
-void QueueAsyncTaskLP(const GenericTask& func);
-void QueueAsyncTaskHP(const GenericTask& func);
-void WaitForAsyncTasks();
-void AbortAsyncTasks();
-int GetAsyncTasksRemaining();
+// job is the group to add the task to, a new one when empty - the group is returned either way
+JobHandle QueueAsyncTaskLP(const GenericTask& func, const JobHandle& job = nullptr);
+JobHandle QueueAsyncTaskHP(const GenericTask& func, const JobHandle& job = nullptr);
+// func(0..count-1) queued in one go, indices are started in order
+JobHandle QueueAsyncForLP(int count, const std::function<void(int)>& func, const JobHandle& job = nullptr);
+JobHandle QueueAsyncForHP(int count, const std::function<void(int)>& func, const JobHandle& job = nullptr);
 
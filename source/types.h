@@ -1,6 +1,8 @@
 #pragma once
 
+#include <atomic>
 #include <functional>
+#include <memory>
 
 typedef uint64_t        u64;
 typedef int64_t         i64;
@@ -14,3 +16,15 @@ typedef float           f32;
 typedef double          f64;
 
 typedef std::function<void(void)> GenericTask;
+
+// a group of queued tasks to wait on - kept alive by anything queued into it or waiting on it
+class TaskGroup;
+typedef std::shared_ptr<TaskGroup> JobHandle;
+
+// cancel flag of the job whose task this thread is running, null outside a job
+// long loops poll JobCancelled() a row or band at a time and give up early - the caller throws away what they leave
+extern thread_local const std::atomic<bool>* t_jobCancel;
+inline bool JobCancelled()
+{
+    return t_jobCancel && t_jobCancel->load(std::memory_order_relaxed);
+}